@@ -0,0 +1,397 @@
+#include "script/FlowScript.hpp"
+#include "core/FlowEvent.hpp"
+#include "3rdparty/nlohmann/json.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+// Benchmarks of the core engine operations. Results are written as JSON to stdout,
+// or to the file passed as first argument, so that runs can be compared against each other.
+//
+// Usage: nodeflow-benchmark [output.json] [epochs]
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * @brief Keeps the compiler from discarding a value computed by a benchmarked operation
+	*/
+	template<typename T>
+	void doNotOptimizeAway(const T& value)
+	{
+		static const void* volatile sink;
+		sink = &value;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+	}
+
+	struct BenchmarkResult
+	{
+		std::string name;
+		size_t batch = 0; // Operations timed per epoch
+		std::vector<double> nsPerOp; // One entry per epoch
+	};
+
+	/**
+	 * @brief Times operations in several epochs and reports the median, min and max time per operation.
+	 * Each epoch calls 'setup' first, which prepares fresh state outside of the measurement and returns
+	 * the operation to time. The operation is called with the indices 0 to 'batch' - 1.
+	*/
+	class BenchmarkRunner
+	{
+	public:
+		explicit BenchmarkRunner(size_t epochs)
+			: m_epochs(epochs)
+		{
+		}
+
+		template<class Setup>
+		void run(const std::string& name, size_t batch, Setup&& setup)
+		{
+			BenchmarkResult result{ name, batch, {} };
+			for (size_t epoch = 0; epoch < m_epochs; epoch++)
+			{
+				auto operation = setup();
+
+				const auto start = Clock::now();
+				for (size_t i = 0; i < batch; i++)
+					operation(i);
+				const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start);
+
+				result.nsPerOp.push_back(elapsed.count() / static_cast<double>(batch));
+			}
+
+			std::sort(result.nsPerOp.begin(), result.nsPerOp.end());
+			std::cerr << name << ": " << result.nsPerOp[result.nsPerOp.size() / 2] << " ns/op\n";
+			m_results.push_back(std::move(result));
+		}
+
+		nlohmann::json toJson() const
+		{
+			nlohmann::json document;
+			document["epochs"] = m_epochs;
+			document["benchmarks"] = nlohmann::json::array();
+			for (const auto& result : m_results)
+			{
+				document["benchmarks"].push_back({
+					{ "name", result.name },
+					{ "unit", "ns/op" },
+					{ "batch", result.batch },
+					{ "median", result.nsPerOp[result.nsPerOp.size() / 2] },
+					{ "min", result.nsPerOp.front() },
+					{ "max", result.nsPerOp.back() }
+				});
+			}
+			return document;
+		}
+
+	private:
+		size_t m_epochs;
+		std::vector<BenchmarkResult> m_results;
+	};
+
+	int increment(int x)
+	{
+		return x + 1;
+	}
+
+	class BenchmarkEvent : public nf::FlowEvent
+	{
+		NF_REGISTER_EVENT(BenchmarkEvent)
+
+	public:
+		explicit BenchmarkEvent(int value)
+			: value(value)
+		{
+		}
+
+		int value;
+	};
+
+	/**
+	 * @brief Does nothing but counting the BenchmarkEvents it receives
+	*/
+	class EventCounterNode : public nf::FlowNode
+	{
+	public:
+		NF_NODE_NAME("EventCounter")
+
+	public:
+		nf::Expected<void, nf::Error> setup() override
+		{
+			subscribeEvent<BenchmarkEvent>();
+			return {};
+		}
+
+		bool onEvent(nf::FlowEvent* event) override
+		{
+			if (auto benchmarkEvent = nf::event_cast<BenchmarkEvent>(event))
+			{
+				m_received += benchmarkEvent->value;
+				return true;
+			}
+			return false;
+		}
+
+	private:
+		int m_received = 0;
+	};
+
+	std::shared_ptr<nf::FlowModule> makeModule()
+	{
+		auto module = std::make_shared<nf::FlowModule>();
+		(void)module->registerType<int>("int");
+		(void)module->registerFunction<&increment>("Increment");
+		(void)module->registerCustomNode<EventCounterNode>("EventCounter");
+		return module;
+	}
+
+	std::vector<nf::NodeHandle> spawnNodes(nf::FlowScript& script, const std::string& namePath, size_t count)
+	{
+		std::vector<nf::NodeHandle> handles;
+		handles.reserve(count);
+		for (size_t i = 0; i < count; i++)
+			handles.push_back(script.spawnNode(namePath).value());
+		return handles;
+	}
+
+	void benchmarkSpawnNode(BenchmarkRunner& runner, const std::shared_ptr<nf::FlowModule>& module)
+	{
+		for (const std::string namePath : { "int", "Increment" })
+		{
+			runner.run("spawnNode/" + namePath, 10'000, [&]() {
+				auto script = std::make_shared<nf::FlowScript>(module);
+				return [script, namePath](size_t) {
+					doNotOptimizeAway(script->spawnNode(namePath));
+				};
+			});
+		}
+
+		// Lifetime of a whole graph, including the release of all nodes with the script
+		runner.run("script/build+teardown/100k", 1, [&]() {
+			return [&](size_t) {
+				nf::FlowScript script(module);
+				doNotOptimizeAway(spawnNodes(script, "Increment", 100'000));
+			};
+		});
+	}
+
+	void benchmarkConnections(BenchmarkRunner& runner, const std::shared_ptr<nf::FlowModule>& module)
+	{
+		constexpr size_t nodeCount = 10'000;
+
+		// Connects the nodes to a chain
+		runner.run("connectPorts/10k", nodeCount - 1, [&]() {
+			auto script = std::make_shared<nf::FlowScript>(module);
+			auto nodes = spawnNodes(*script, "Increment", nodeCount);
+			return [script, nodes](size_t i) {
+				doNotOptimizeAway(script->connectPorts(nodes[i], 0, nodes[i + 1], 0));
+			};
+		});
+
+		runner.run("disconnectPorts/10k", nodeCount - 1, [&]() {
+			auto script = std::make_shared<nf::FlowScript>(module);
+			auto nodes = spawnNodes(*script, "Increment", nodeCount);
+			for (size_t i = 0; i + 1 < nodeCount; i++)
+				(void)script->connectPorts(nodes[i], 0, nodes[i + 1], 0);
+
+			return [script, nodes](size_t i) {
+				doNotOptimizeAway(script->disconnectPorts(nodes[i], 0, nodes[i + 1], 0));
+			};
+		});
+
+		// Connects the output of the first node to all other nodes
+		runner.run("connectPorts/fan-out/10k", nodeCount - 1, [&]() {
+			auto script = std::make_shared<nf::FlowScript>(module);
+			auto nodes = spawnNodes(*script, "Increment", nodeCount);
+			return [script, nodes](size_t i) {
+				doNotOptimizeAway(script->connectPorts(nodes[0], 0, nodes[i + 1], 0));
+			};
+		});
+
+		runner.run("disconnectPorts/fan-out/10k", nodeCount - 1, [&]() {
+			auto script = std::make_shared<nf::FlowScript>(module);
+			auto nodes = spawnNodes(*script, "Increment", nodeCount);
+			for (size_t i = 1; i < nodeCount; i++)
+				(void)script->connectPorts(nodes[0], 0, nodes[i], 0);
+
+			return [script, nodes](size_t i) {
+				doNotOptimizeAway(script->disconnectPorts(nodes[0], 0, nodes[i + 1], 0));
+			};
+		});
+	}
+
+	void benchmarkBuild(BenchmarkRunner& runner, const std::shared_ptr<nf::FlowModule>& module)
+	{
+		constexpr size_t nodeCount = 100'000;
+
+		// Topology pass over a chain connected by data and flow: ordering, validation and scheduling of every node
+		runner.run("script/build/100k", 1, [&]() {
+			auto script = std::make_shared<nf::FlowScript>(module);
+			auto source = script->spawnNode("int").value();
+			auto nodes = spawnNodes(*script, "Increment", nodeCount);
+			(void)script->connectPorts(source, 0, nodes[0], 0);
+			(void)script->connectFlow(script->startEventNode().handle(), nodes[0]);
+			for (size_t i = 0; i + 1 < nodeCount; i++)
+			{
+				(void)script->connectPorts(nodes[i], 0, nodes[i + 1], 0);
+				(void)script->connectFlow(nodes[i], nodes[i + 1]);
+			}
+
+			return [script](size_t) {
+				doNotOptimizeAway(script->build());
+			};
+		});
+	}
+
+	void benchmarkRemoveNode(BenchmarkRunner& runner, const std::shared_ptr<nf::FlowModule>& module)
+	{
+		constexpr size_t nodeCount = 10'000;
+
+		// Removes all nodes of a connected chain in random order
+		runner.run("removeNode/10k", nodeCount, [&]() {
+			auto script = std::make_shared<nf::FlowScript>(module);
+			auto nodes = spawnNodes(*script, "Increment", nodeCount);
+			for (size_t i = 0; i + 1 < nodeCount; i++)
+				(void)script->connectPorts(nodes[i], 0, nodes[i + 1], 0);
+
+			std::shuffle(nodes.begin(), nodes.end(), std::mt19937(42));
+			return [script, nodes](size_t i) {
+				doNotOptimizeAway(script->removeNode(nodes[i]));
+			};
+		});
+	}
+
+	void benchmarkFindNode(BenchmarkRunner& runner, const std::shared_ptr<nf::FlowModule>& module)
+	{
+		constexpr size_t lookupCount = 1'000;
+
+		for (size_t nodeCount : { 10'000, 100'000 })
+		{
+			// Half of the nodes are DataNodes, which are stored separately from the FlowNodes
+			nf::FlowScript script(module);
+			auto nodes = spawnNodes(script, "Increment", nodeCount / 2);
+			auto dataNodes = spawnNodes(script, "int", nodeCount / 2);
+			nodes.insert(nodes.end(), dataNodes.begin(), dataNodes.end());
+
+			std::vector<nf::NodeHandle> lookups;
+			std::mt19937 random(42);
+			std::uniform_int_distribution<size_t> distribution(0, nodes.size() - 1);
+			for (size_t i = 0; i < lookupCount; i++)
+				lookups.push_back(nodes[distribution(random)]);
+
+			runner.run("findNode/" + std::to_string(nodeCount / 1'000) + "k", lookupCount, [&]() {
+				return [&](size_t i) {
+					doNotOptimizeAway(script.findNode(lookups[i]));
+				};
+			});
+		}
+	}
+
+	void benchmarkDispatch(BenchmarkRunner& runner, const std::shared_ptr<nf::FlowModule>& module)
+	{
+		constexpr size_t callCount = 1'000'000;
+
+		// Called through a volatile pointer, so the call can't be inlined either
+		runner.run("dispatch/raw", callCount, [&]() {
+			return [function = static_cast<int(* volatile)(int)>(&increment), x = 0](size_t) mutable {
+				x = function(x);
+				doNotOptimizeAway(x);
+			};
+		});
+
+		nf::FlowScript script(module);
+		auto source = script.spawnNode("int").value();
+		auto functor = script.spawnNode("Increment").value();
+		(void)script.connectPorts(source, 0, functor, 0);
+		nf::Node* node = script.findNode(functor);
+
+		runner.run("dispatch/FunctorNode", callCount, [&]() {
+			return [node](size_t) {
+				node->process();
+				doNotOptimizeAway(node);
+			};
+		});
+	}
+
+	void benchmarkBroadcastEvent(BenchmarkRunner& runner, const std::shared_ptr<nf::FlowModule>& module)
+	{
+		constexpr size_t subscriberCount = 1'000;
+
+		nf::FlowScript script(module);
+		spawnNodes(script, "EventCounter", subscriberCount);
+		// Nodes not subscribed to the event must not slow down the broadcast
+		spawnNodes(script, "Increment", subscriberCount);
+
+		runner.run("broadcastEvent/1k-subscribers", 10'000, [&]() {
+			return [&](size_t i) {
+				script.broadcastEvent<BenchmarkEvent>(static_cast<int>(i));
+			};
+		});
+	}
+
+	void benchmarkSaveLoad(BenchmarkRunner& runner, const std::shared_ptr<nf::FlowModule>& module)
+	{
+		constexpr size_t nodeCount = 10'000;
+
+		nf::FlowScript script(module);
+		auto nodes = spawnNodes(script, "int", nodeCount);
+
+		// Saves the values of all DataNodes into one document, keyed by their persistent UUID
+		auto save = [&]() {
+			nlohmann::json document;
+			for (nf::NodeHandle node : nodes)
+				document[std::to_string(static_cast<std::uint64_t>(script.findNode(node)->uuid()))] = script.nodeOutputAsStr(node, 0);
+			return document.dump();
+		};
+
+		runner.run("script/save/10k", 1, [&]() {
+			return [&](size_t) {
+				doNotOptimizeAway(save());
+			};
+		});
+
+		const std::string saved = save();
+		runner.run("script/load/10k", 1, [&]() {
+			return [&](size_t) {
+				auto document = nlohmann::json::parse(saved);
+				for (const auto& [uuid, value] : document.items())
+				{
+					nf::NodeHandle node = script.findHandle(nf::UUID::createFrom(std::stoull(uuid)));
+					script.setNodeOutputFromStr(node, 0, value.get<std::string>());
+				}
+			};
+		});
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const size_t epochs = (argc > 2) ? std::stoul(argv[2]) : 11;
+
+	auto module = makeModule();
+	BenchmarkRunner runner(epochs);
+
+	benchmarkSpawnNode(runner, module);
+	benchmarkConnections(runner, module);
+	benchmarkBuild(runner, module);
+	benchmarkRemoveNode(runner, module);
+	benchmarkFindNode(runner, module);
+	benchmarkDispatch(runner, module);
+	benchmarkBroadcastEvent(runner, module);
+	benchmarkSaveLoad(runner, module);
+
+	const std::string json = runner.toJson().dump(4);
+	if (argc > 1)
+		std::ofstream(argv[1]) << json << "\n";
+	else
+		std::cout << json << "\n";
+
+	return 0;
+}
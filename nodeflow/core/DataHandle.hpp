@@ -32,11 +32,52 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #pragma once
+#include <memory>
+#include <span>
+#include <algorithm>
+#include <new>
+#include <type_traits>
+
 #include "reflection/type_reflection.hpp"
 
 
 namespace nf::detail
 {
+	/**
+	 * @brief Type-erased lifetime operations of a port value. Used to lay out values of unknown type in raw memory.
+	*/
+	struct TypeOps
+	{
+		size_t size = 0;
+		size_t alignment = 0;
+		void (*copyConstruct)(void* dst, const void* src) = nullptr; // nullptr if the type is not copyable
+		void (*destroy)(void* ptr) = nullptr;
+	};
+
+	template<typename T>
+	void copyConstructValue(void* dst, const void* src)
+	{
+		::new (dst) T(*static_cast<const T*>(src));
+	}
+
+	template<typename T>
+	void destroyValue(void* ptr)
+	{
+		static_cast<T*>(ptr)->~T();
+	}
+
+	template<typename T>
+	const TypeOps& typeOpsOf()
+	{
+		static constexpr TypeOps ops = [] {
+			TypeOps result{ sizeof(T), alignof(T), nullptr, &destroyValue<T> };
+			if constexpr (std::is_copy_constructible_v<T>)
+				result.copyConstruct = &copyConstructValue<T>;
+			return result;
+		}();
+		return ops;
+	}
+
 	class DataHandle
 	{
 	public:
@@ -112,7 +153,85 @@ namespace nf::detail
 		typeid_t m_typeid = 0;
 		void* m_dataptr = nullptr;
 	};
-}
 
+	/**
+	 * @brief Contiguous storage of the values of an output port in batch mode. One value per record.
+	 * Unlike std::vector<T> it also provides contiguous storage for bool.
+	*/
+	template<typename T>
+	class ColumnBuffer
+	{
+	public:
+		ColumnBuffer() = default;
+
+		/**
+		 * @brief Resizes the column. Existing values are only kept if the size doesn't change.
+		*/
+		void resize(size_t size)
+		{
+			if (size == m_size)
+				return;
+			m_data = (size != 0) ? std::make_unique<T[]>(size) : nullptr;
+			m_size = size;
+		}
+
+		void assign(std::span<const T> values)
+		{
+			resize(values.size());
+			std::copy(values.begin(), values.end(), m_data.get());
+		}
+
+		inline T* data() noexcept { return m_data.get(); }
+
+		inline const T* data() const noexcept { return m_data.get(); }
+
+		inline size_t size() const noexcept { return m_size; }
+
+		inline std::span<const T> span() const noexcept { return { m_data.get(), m_size }; }
 
+	private:
+		std::unique_ptr<T[]> m_data;
+		size_t m_size = 0;
+	};
+
+	/**
+	 * @brief Type-erased reference to the ColumnBuffer of an output port
+	*/
+	class ColumnHandle
+	{
+	public:
+		ColumnHandle() = default;
+
+		template<typename T>
+		ColumnHandle(ColumnBuffer<T>& column, typeid_t typeID)
+			: m_typeid(typeID), m_column(static_cast<void*>(&column)), m_data(&dataOf<T>), m_size(&sizeOf<T>)
+		{
+		}
 
+		template<typename Type>
+		ColumnBuffer<Type>* get() const
+		{
+			static constexpr typeid_t targetID = nf::type_id<Type>();
+			if (m_column == nullptr || m_typeid != targetID)
+				return nullptr;
+			return static_cast<ColumnBuffer<Type>*>(m_column);
+		}
+
+		inline const void* data() const { return m_column ? m_data(m_column) : nullptr; }
+
+		inline size_t size() const { return m_column ? m_size(m_column) : 0; }
+
+	private:
+		template<typename T>
+		static const void* dataOf(const void* column) { return static_cast<const ColumnBuffer<T>*>(column)->data(); }
+
+		template<typename T>
+		static size_t sizeOf(const void* column) { return static_cast<const ColumnBuffer<T>*>(column)->size(); }
+
+	private:
+		typeid_t m_typeid = 0;
+		void* m_column = nullptr;
+		const void* (*m_data)(const void*) = nullptr;
+		size_t (*m_size)(const void*) = nullptr;
+	};
+}
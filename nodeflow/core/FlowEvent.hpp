@@ -69,7 +69,7 @@ namespace nf
 	{
 		if (from->eventType() == To::type)
 		{
-			return STATIC_CAST<To*>(from);
+			return static_cast<To*>(from);
 		}
 		return nullptr;
 	}
@@ -1,15 +1,26 @@
 #include "core/Node.hpp"
+#include <iterator>
 #include "../3rdparty/cpputils/prettyprint.h"
 using namespace cpputils;
 
 namespace nf
 {
 
-	std::string Node::portName(PortDirection dir, PortIndex index) const
+	Node::~Node()
+	{
+		// Rows in a shared table are given back to the other nodes
+		if (m_portTable != nullptr && m_portTable != m_ownPortTable.get())
+		{
+			m_portTable->releaseRows(PortDirection::Input, *this);
+			m_portTable->releaseRows(PortDirection::Output, *this);
+		}
+	}
+
+	std::string_view Node::portName(PortDirection dir, PortIndex index) const
 	{
 		NF_UNUSED(dir);
 		NF_UNUSED(index);
-		return "";
+		return {};
 	}
 
 	NodeArchetype Node::getArchetype() const
@@ -44,17 +55,24 @@ namespace nf
 		}
 	}
 
-	const std::vector<InputPortHandle>& Node::getInputPortList() const noexcept
+	const Node::InputPortList& Node::getInputPortList() const noexcept
 	{
 		return m_inputPorts;
 	}
 
-	const std::vector<OutputPortHandle>& Node::getOutputPortList() const noexcept
+	const Node::OutputPortList& Node::getOutputPortList() const noexcept
 	{
 		return m_outputPorts;
 	}
 
 
+	std::span<const PortLink> Node::inputLinks() const noexcept
+	{
+		if (m_portTable == nullptr)
+			return {};
+		return m_portTable->inputLinks().subspan(m_inputRange.first, m_inputRange.count);
+	}
+
 	const InputPortHandle& Node::getInputPort(PortIndex index) const
 	{
 		NF_ASSERT(index != -1, "Invalid port index");
@@ -88,6 +106,23 @@ namespace nf
 		return &port;
 	}
 
+	void Node::markOutputChanged(PortIndex index)
+	{
+		NF_ASSERT(index != -1, "Invalid port index");
+		NF_ASSERT(index < m_outputPorts.size(), "Port index out of range");
+		m_outputPorts[index].markChanged();
+	}
+
+	void Node::markAllOutputsChanged() noexcept
+	{
+		if (m_portTable == nullptr)
+			return;
+
+		auto& versions = m_portTable->m_outputVersions;
+		for (auto row = m_outputRange.first; row < m_outputRange.first + m_outputRange.count; row++)
+			versions[row]++;
+	}
+
 	void Node::formatLinkageTree(std::ostringstream& stream) const
 	{
 	    stream << "LinkageTree for [Node:" << nodeName() << " @" << this <<"]\n";
@@ -205,11 +240,14 @@ namespace nf
 			for (size_t i = 0; i < m_outputPorts.size(); i++)
 			{
 				auto& originPort = m_outputPorts[i];
-				for (const PortLink& outToInLink : originPort.links())
+				// Breaking a connection removes the link from the list, so it's not iterated
+				while (originPort.linkCount() != 0)
 				{
+					const PortLink outToInLink = originPort.links().back();
 					if (!outToInLink.valid())
 					{
 						NF_ASSERT(false, "Out-Link not valid. Why is that?");
+						originPort.removeLink(outToInLink);
 						continue;
 					}
 					auto success = breakConnection(static_cast<PortIndex>(i),
@@ -253,5 +291,62 @@ namespace nf
 		}
 	}
 
+	namespace
+	{
+		template<class PortList>
+		void rebindPortList(PortList& ports, std::pmr::memory_resource& resource)
+		{
+			if (ports.get_allocator().resource() == &resource)
+				return;
+
+			// Keeps the capacity reserved by allocateExpectedPortCount()
+			PortList rebound(&resource);
+			rebound.reserve(ports.capacity());
+			std::move(ports.begin(), ports.end(), std::back_inserter(rebound));
+
+			// pmr containers never adopt the allocator of another container on assignment, so the list is reconstructed
+			std::destroy_at(&ports);
+			std::construct_at(&ports, std::move(rebound));
+		}
+	}
+
+	void Node::setPortResource(std::pmr::memory_resource& resource)
+	{
+		rebindPortList(m_inputPorts, resource);
+		rebindPortList(m_outputPorts, resource);
+	}
+
+	void Node::setPortTable(PortTable& table)
+	{
+		NF_ASSERT(m_inputPorts.empty() && m_outputPorts.empty(), "Port table must be set before ports are added");
+		m_portTable = &table;
+	}
+
+	PortTable& Node::portTable()
+	{
+		if (m_portTable == nullptr)
+		{
+			m_ownPortTable = std::make_unique<PortTable>();
+			m_portTable = m_ownPortTable.get();
+		}
+		return *m_portTable;
+	}
+
+	void Node::movePorts(PortDirection dir, std::uint32_t first) noexcept
+	{
+		if (dir == PortDirection::Input)
+		{
+			m_inputRange.first = first;
+			for (std::uint32_t i = 0; i < m_inputPorts.size(); i++)
+				m_inputPorts[i].m_row = first + i;
+		}
+		else
+		{
+			m_outputRange.first = first;
+			for (std::uint32_t i = 0; i < m_outputPorts.size(); i++)
+				m_outputPorts[i].m_row = first + i;
+		}
+	}
+
 
 }
@@ -34,20 +34,68 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 #include <vector>
 #include <string>
+#include <cstddef>
 #include <string_view>
 #include <sstream>
+#include <algorithm>
 #include <unordered_map>
+#include <memory>
+#include <memory_resource>
+#include <span>
 
 #include "typedefs.hpp"
 #include "core/NodePort.hpp"
 #include "core/Error.hpp"
 #include "core/UUID.hpp"
+#include "core/NodeHandle.hpp"
 #include "core/FlowEvent.hpp"
 #include "utility/Expected.hpp"
 #include "utility/TypenameAtlas.hpp"
 
 namespace nf
 {
+	class ExecutionPlan;
+	class FlowScript;
+	class Node;
+
+	/**
+	 * @brief Entry point the ExecutionPlan calls instead of the virtual Node::process().
+	 * 'inputs' holds the resolved data pointer of each input port, in port order.
+	*/
+	using ProcessThunk = void(*)(Node* self, void* const* inputs);
+
+	/**
+	 * @brief Input of a node in batch mode. Value of record 'i' is located at 'data[i * stride]'.
+	 * A stride of 0 broadcasts a single value to all records.
+	*/
+	struct ColumnView
+	{
+		const void* data = nullptr;
+		size_t stride = 0;
+	};
+
+	/**
+	 * @brief Executes a node for 'count' records at once and writes the results into the column of each output port
+	*/
+	using BatchThunk = void(*)(Node* self, const ColumnView* inputs, size_t count);
+
+	/**
+	 * @brief Executes a node on the values of a FlowInstance instead of its own ports.
+	 * 'offsets' holds the byte offset of each input followed by each output within 'values'.
+	 * Must not modify the node, as it is shared by all instances of a FlowGraph.
+	*/
+	using InstanceThunk = void(*)(const Node* self, std::byte* values, const std::uint32_t* offsets);
+
+	/**
+	 * @brief C++ function a node calls, used when a script is exported as native code.
+	 * 'name' must address a single free function, ex. "nf::add<float>". 'header' declares it.
+	*/
+	struct NativeSymbol
+	{
+		std::string name;
+		std::string header;
+	};
+
 	enum class NodeArchetype
 	{
 		Node,
@@ -57,7 +105,10 @@ namespace nf
 		Flow_ConversionNode,
 		Flow_FunctorNode,
 		Flow_CustomNode,
-		Lang_IfElse
+		Flow_LatentNode,
+		Lang_IfElse,
+		Lang_WhileLoop,
+		Lang_ForLoop
 	};
 
 	enum class ConnectionError
@@ -77,16 +128,25 @@ namespace nf
 
 	class Node
 	{
+		friend ExecutionPlan;
+		friend FlowScript;
+		friend PortTable;
+
+	public:
+		using InputPortList = std::pmr::vector<InputPortHandle>;
+		using OutputPortList = std::pmr::vector<OutputPortHandle>;
+
 	public:
 		Node() = default;
-		virtual ~Node() = default;
+		virtual ~Node();
 
 	public: // Or better private and friend FlowScript
 
 		/**
-		 * @brief Returns the name of the node
+		 * @brief Returns the name of the node.
+		 * The text must outlive the node, ex. a string literal or an InternedName.
 // 		*/
-		virtual std::string nodeName() const = 0;
+		virtual std::string_view nodeName() const = 0;
 
 		inline void assignTypeID(typeid_t id) noexcept
 		{
@@ -95,9 +155,9 @@ namespace nf
 
 		/**
 		 * @brief Returns the name of a specific port attached to this node.
-		 * Behaviour is implemented in derived classes
+		 * Behaviour is implemented in derived classes. The text must outlive the node, like the one of nodeName().
 		*/
-		virtual std::string portName(PortDirection dir, PortIndex index) const;
+		virtual std::string_view portName(PortDirection dir, PortIndex index) const;
 
 		/**
 		 * @brief Returns the archetype of a node and therefore describes its behaviour.
@@ -106,6 +166,13 @@ namespace nf
 		*/
 		virtual NodeArchetype getArchetype() const;
 
+		/**
+		 * @brief Pure nodes compute their outputs solely from their inputs and have no side effects.
+		 * With incremental evaluation enabled, FlowScript skips them while their inputs are unchanged.
+		 * @return 'false' by default
+		*/
+		virtual bool isPure() const { return false; }
+
 		/**
 		 * @brief Allows the de/serialization of node output ports depending on the StreamFlag.
 		 * Useful if you want to read the outputs of nodes in the GUI or set them via widgets.
@@ -115,14 +182,45 @@ namespace nf
 		virtual bool streamOutput(PortIndex index, StreamFlag flag, std::stringstream& archive);
 
 		/**
-		 * @brief Users can override to react on their custom events emitted from FlowScript
+		 * @brief Users can override to react on their custom events emitted from FlowScript.
+		 * Only called for event types the node subscribed to via subscribeEvent().
 		 * @param event
 		 * @return
 		*/
 		virtual bool onEvent(FlowEvent* event) { NF_UNUSED(event); return false; }
 
+		/**
+		 * @brief Returns the type ids of all FlowEvents the node subscribed to
+		*/
+		inline const std::vector<typeid_t>& eventSubscriptions() const noexcept { return m_eventSubscriptions; }
+
 		virtual Expected<void, Error> onBuild() { return {}; }
 
+		/**
+		 * @brief Returns the function the ExecutionPlan calls to execute this node. Queried once per build.
+		 * Nodes can return a non-virtual thunk that reads the bound input pointers directly.
+		 * @return a thunk that calls process() by default
+		*/
+		virtual ProcessThunk processThunk() const { return &Node::invokeProcess; }
+
+		/**
+		 * @brief Returns the function used to execute this node in batch mode.
+		 * @return nullptr if the node doesn't support batch execution (default)
+		*/
+		virtual BatchThunk batchThunk() const { return nullptr; }
+
+		/**
+		 * @brief Returns the function used to execute this node for a FlowInstance.
+		 * @return nullptr if the node keeps state and can't be shared between instances (default)
+		*/
+		virtual InstanceThunk instanceThunk() const { return nullptr; }
+
+		/**
+		 * @brief Returns the C++ function the node calls when exported as native code.
+		 * @return nullptr if the node can't be exported (default)
+		*/
+		virtual const NativeSymbol* nativeSymbol() const { return nullptr; }
+
 		/**
 		 * @brief Called when node is about to be removed/deleted from a FlowScript.
 		 * Might be used to do clean up stuff.
@@ -159,6 +257,23 @@ namespace nf
 
 		void setUUID(UUID uuid) noexcept;
 
+		/**
+		 * @brief Returns the handle of this node within the FlowScript that spawned it
+		*/
+		inline NodeHandle handle() const noexcept { return m_handle; }
+
+		/**
+		 * @brief Moves the port tables into memory of 'resource', ports added later are allocated from it as well.
+		 * Must be called before the node is connected. 'resource' must outlive the node (see makeNode()).
+		*/
+		void setPortResource(std::pmr::memory_resource& resource);
+
+		/**
+		 * @brief Stores the ports of the node in 'table', shared with other nodes. Nodes without one get a table of their own.
+		 * Must be called before ports are added. 'table' must outlive the node.
+		*/
+		void setPortTable(PortTable& table);
+
 		/**
 		 * @brief Returns the number of ports used in the node
 		 * @param dir Input or Output
@@ -168,12 +283,17 @@ namespace nf
 		/**
 		 * @brief Returns all input ports of the node
 		*/
-		const std::vector<InputPortHandle>& getInputPortList() const noexcept;
+		const InputPortList& getInputPortList() const noexcept;
 
 		/**
 		 * @brief Returns all output ports of the node
 		*/
-		const std::vector<OutputPortHandle>& getOutputPortList() const noexcept;
+		const OutputPortList& getOutputPortList() const noexcept;
+
+		/**
+		 * @brief Returns the links of all input ports in port order, read from contiguous rows of the PortTable
+		*/
+		std::span<const PortLink> inputLinks() const noexcept;
 
 		/**
 		 * @brief Returns input port of node specified by 'index'
@@ -199,6 +319,28 @@ namespace nf
 		*/
 		const OutputPortHandle* findOutputPort(PortIndex index) const;
 
+		/**
+		 * @brief Notifies connected nodes that the value of an output port was changed from outside of process().
+		*/
+		void markOutputChanged(PortIndex index);
+
+		/**
+		 * @brief Increases the version of all output ports at once. Called after the node was executed.
+		*/
+		void markAllOutputsChanged() noexcept;
+
+		/**
+		 * @brief Returns the column used by an output port in batch mode.
+		 * @return nullptr if port does not exist or 'T' is not the type of the port
+		*/
+		template<typename T>
+		detail::ColumnBuffer<T>* outputColumn(PortIndex index) const
+		{
+			if (index == -1 || !(index < m_outputPorts.size()))
+				return nullptr;
+			return m_outputPorts[index].columnHandle().get<T>();
+		}
+
 		void formatLinkageTree(std::ostringstream& stream) const;
 
 		/**
@@ -229,7 +371,7 @@ namespace nf
 		 * @return 'false' if port was already added.
 		*/
 		template<typename T>
-		bool addPort(InputPort<T>& p, const std::string& caption = "");
+		bool addPort(InputPort<T>& p, std::string_view caption = {});
 
 		/**
 		 * @brief Adds an Output of type 'T' to the node.
@@ -239,7 +381,7 @@ namespace nf
 		 * @return 'false' if port was already added.
 		*/
 		template<typename T>
-		bool addPort(OutputPort<T>& p, const std::string& caption = "");
+		bool addPort(OutputPort<T>& p, std::string_view caption = {});
 
 		/**
 		 * @brief Retrieve the data of the output port of a node connected to this port.
@@ -250,13 +392,16 @@ namespace nf
 		template<typename T>
 		const T* getInputData(const InputPort<T>& p) const
 		{
-			const PortLink& link = m_inputPorts[p.m_portIndex].m_link;
+			// Inputs were resolved by the ExecutionPlan. Saves the link and typeid lookup.
+			if (m_boundInputs)
+				return static_cast<const T*>(m_boundInputs[p.m_portIndex]);
+
+			const PortLink& link = m_portTable->m_inputLinks[m_inputRange.first + p.m_portIndex];
 			// No input connection
 			if (!link.valid())
 				return nullptr;
 
-			const detail::DataHandle& datahandle = link.targetNode->m_outputPorts[link.targetIndex].m_dataHandle;
-			return datahandle.get<T>();
+			return link.targetNode->m_outputPorts[link.targetIndex].dataHandle().get<T>();
 		}
 
 		/**
@@ -268,13 +413,15 @@ namespace nf
 		template<typename T>
 		T* getInputDataMutable(const InputPort<T>& p) const
 		{
-			const PortLink& link = m_inputPorts[p.m_portIndex].m_link;
+			const PortLink& link = m_portTable->m_inputLinks[m_inputRange.first + p.m_portIndex];
 			// No input connection
 			if (!link.valid())
 				return nullptr;
 
-			detail::DataHandle& datahandle = link.targetNode->m_outputPorts[link.targetIndex].m_dataHandle;
-			return datahandle.getMutable<T>();
+			// The caller is expected to modify the data, so readers of that port need to be notified
+			auto& targetPort = link.targetNode->m_outputPorts[link.targetIndex];
+			targetPort.markChanged();
+			return targetPort.m_table->m_outputData[targetPort.m_row].getMutable<T>();
 		}
 
 		/**
@@ -294,18 +441,97 @@ namespace nf
 		*/
 		void allocateExpectedPortCount(PortDirection dir, size_t size);
 
+		/**
+		 * @brief Lets FlowScript deliver events of type 'EventType' to onEvent().
+		 * Must be called in 'setup' function, FlowScript indexes the subscriptions right afterwards.
+		*/
+		template<typename EventType>
+		void subscribeEvent()
+		{
+			if (std::find(m_eventSubscriptions.begin(), m_eventSubscriptions.end(), EventType::type) == m_eventSubscriptions.end())
+				m_eventSubscriptions.push_back(EventType::type);
+		}
+
 	protected:
-		std::vector<OutputPortHandle> m_outputPorts;
-		std::vector<InputPortHandle> m_inputPorts;
+		OutputPortList m_outputPorts;
+		InputPortList m_inputPorts;
 		UUID m_uuid;
+
+	private:
+		std::vector<typeid_t> m_eventSubscriptions;
+		NodeHandle m_handle; // Assigned by FlowScript when the node is added
+
+		// Rows of the ports in the port table. The handles in m_inputPorts/m_outputPorts refer to them.
+		PortTable* m_portTable = nullptr;
+		std::unique_ptr<PortTable> m_ownPortTable; // Only used if the node isn't part of a FlowScript
+		PortRange m_inputRange;
+		PortRange m_outputRange;
+
+	private:
+		PortTable& portTable();
+
+		/**
+		 * @brief Lets the port handles refer to the rows starting at 'first', after PortTable moved them
+		*/
+		void movePorts(PortDirection dir, std::uint32_t first) noexcept;
+
+		static void invokeProcess(Node* self, void* const* inputs) 
+		{ 
+			NF_UNUSED(inputs);
+			self->process(); 
+		}
+
+	private:
+		// Set by the ExecutionPlan while the node is scheduled. One pointer per input port.
+		void* const* m_boundInputs = nullptr;
 	};
 
+	/**
+	 * @brief Destroys a node created by makeNode() and returns its memory to the resource it came from
+	*/
+	struct NodeDeleter
+	{
+		std::pmr::memory_resource* resource = nullptr;
+		size_t size = 0;
+		size_t alignment = 0;
+
+		template<class T>
+		void operator()(T* node) const noexcept
+		{
+			// 'node' may point to a base of the allocated object
+			void* memory = dynamic_cast<void*>(node);
+			node->~T();
+			resource->deallocate(memory, size, alignment);
+		}
+	};
+
+	template<class T>
+	using NodePtr = std::unique_ptr<T, NodeDeleter>;
+
+	/**
+	 * @brief Constructs a node of type 'T' in memory of 'resource'. Its port tables are allocated from 'resource' too.
+	 * 'resource' must outlive the node.
+	*/
+	template<class T>
+	NodePtr<T> makeNode(std::pmr::memory_resource& resource)
+	{
+		static_assert(std::is_base_of_v<Node, T>, "<T> needs to be of base <nf::Node>");
+
+		T* node = std::pmr::polymorphic_allocator<T>(&resource).template new_object<T>();
+		node->setPortResource(resource);
+		return NodePtr<T>(node, NodeDeleter{ &resource, sizeof(T), alignof(T) });
+	}
+
 	template<typename T>
-	bool Node::addPort(InputPort<T>& p, const std::string& caption /*= ""*/)
+	bool Node::addPort(InputPort<T>& p, std::string_view caption /*= {}*/)
 	{
 		if (p.assigned())
 			return false;
-		m_inputPorts.emplace_back(p.typeID, caption);
+		PortTable& table = portTable();
+		const std::uint32_t row = table.appendRow(PortDirection::Input, *this);
+		table.m_inputTypes[row] = p.typeID;
+		table.m_inputNames[row] = InternedName(caption);
+		m_inputPorts.emplace_back(table, row);
 		p.setIndex(static_cast<int>(m_inputPorts.size() - 1));
 
 		auto& atlas = TypenameAtlas::instance();
@@ -315,11 +541,17 @@ namespace nf
 	}
 
 	template<typename T>
-	bool Node::addPort(OutputPort<T>& p, const std::string& caption /*= ""*/)
+	bool Node::addPort(OutputPort<T>& p, std::string_view caption /*= {}*/)
 	{
 		if (p.assigned())
 			return false;
-		m_outputPorts.emplace_back(p.value, p.typeID, caption);
+		PortTable& table = portTable();
+		const std::uint32_t row = table.appendRow(PortDirection::Output, *this);
+		table.m_outputData[row] = detail::DataHandle(p.value, p.typeID);
+		table.m_outputColumns[row] = detail::ColumnHandle(p.column, p.typeID);
+		table.m_outputTypeOps[row] = &detail::typeOpsOf<T>();
+		table.m_outputNames[row] = InternedName(caption);
+		m_outputPorts.emplace_back(table, row);
 		p.setIndex(static_cast<int>(m_outputPorts.size() - 1));
 
 		auto& atlas = TypenameAtlas::instance();
@@ -350,7 +582,7 @@ namespace nf
 
 #define NF_NODE_NAME(name)				\
 public:									\
-std::string nodeName() const override	\
+std::string_view nodeName() const override	\
 {										\
 	return name;						\
 }										\
@@ -359,7 +591,7 @@ std::string nodeName() const override	\
 
 #define NF_PORT_NAMES(inPortNames, outPortNames)						 \
 public:																	 \
-std::string portName(PortDirection dir, PortIndex index) const override  \
+std::string_view portName(PortDirection dir, PortIndex index) const override  \
 {																		 \
 static constexpr std::array inNames = BRACED_INIT_LIST inPortNames;		 \
 static constexpr std::array outNames = BRACED_INIT_LIST outPortNames;	 \
@@ -0,0 +1,87 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+
+namespace nf
+{
+	/**
+	 * @brief Runtime reference to a node of a FlowScript, indexing the script's slot map directly.
+	 * The generation of a slot changes whenever its node is removed, so handles to removed nodes are detected as stale
+	 * even if the slot got reused. Handles are only meaningful to the script that spawned the node and are not
+	 * persistent; the node's UUID is its identity for serialization (see FlowScript::findHandle()).
+	*/
+	class NodeHandle
+	{
+	public:
+		constexpr NodeHandle() noexcept = default;
+
+		constexpr NodeHandle(std::uint32_t index, std::uint32_t generation) noexcept
+			: m_index(index), m_generation(generation)
+		{
+		}
+
+		constexpr std::uint32_t index() const noexcept { return m_index; }
+
+		constexpr std::uint32_t generation() const noexcept { return m_generation; }
+
+		/**
+		 * @brief Returns 'false' for default constructed handles. A valid handle may still be stale.
+		*/
+		constexpr bool valid() const noexcept { return m_index != invalidIndex; }
+
+		friend constexpr bool operator==(NodeHandle, NodeHandle) noexcept = default;
+
+	private:
+		static constexpr std::uint32_t invalidIndex = UINT32_MAX;
+
+		std::uint32_t m_index = invalidIndex;
+		std::uint32_t m_generation = 0;
+	};
+}
+
+namespace std
+{
+	template<>
+	struct hash<nf::NodeHandle>
+	{
+		std::size_t operator()(const nf::NodeHandle& handle) const
+		{
+			return std::hash<std::uint64_t>{}((static_cast<std::uint64_t>(handle.generation()) << 32) | handle.index());
+		}
+	};
+}
@@ -1,4 +1,5 @@
 #include "NodePort.hpp"
+#include "core/Node.hpp"
 
 
 namespace nf
@@ -44,6 +45,308 @@ namespace nf
 
 #pragma endregion FlowLink
 
+#pragma region PortLinkList
+
+	size_t PortLinkList::LinkHash::operator()(const PortLink& link) const noexcept
+	{
+		size_t seed = std::hash<Node*>{}(link.targetNode);
+		seed ^= std::hash<PortIndex>{}(link.targetIndex) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		return seed;
+	}
+
+	PortLinkList::PortLinkList(PortLinkList&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	PortLinkList& PortLinkList::operator=(PortLinkList&& other) noexcept
+	{
+		if (this == &other)
+			return *this;
+
+		clear();
+		if (other.onHeap())
+		{
+			m_heap = other.m_heap;
+			m_capacity = other.m_capacity;
+		}
+		else
+			std::copy(other.m_inline, other.m_inline + other.m_size, m_inline);
+		m_size = other.m_size;
+		m_index = std::move(other.m_index);
+
+		// The heap memory is owned by this list now
+		other.m_size = 0;
+		other.m_capacity = inlineCapacity;
+		return *this;
+	}
+
+	PortLinkList::~PortLinkList()
+	{
+		clear();
+	}
+
+	void PortLinkList::push_back(PortLink link)
+	{
+		NF_ASSERT(!contains(link), "Link is already in the list");
+		if (m_size == m_capacity)
+			grow();
+
+		data()[m_size++] = link;
+		if (m_index)
+			m_index->emplace(link, m_size - 1);
+		else if (m_size >= indexThreshold)
+		{
+			m_index = std::make_unique<Index>();
+			m_index->reserve(m_capacity);
+			for (std::uint32_t i = 0; i < m_size; i++)
+				m_index->emplace(data()[i], i);
+		}
+	}
+
+	bool PortLinkList::contains(PortLink link) const
+	{
+		return find(link) != m_size;
+	}
+
+	bool PortLinkList::erase(PortLink link)
+	{
+		const auto position = find(link);
+		if (position == m_size)
+			return false;
+
+		PortLink* links = data();
+		const PortLink last = links[m_size - 1];
+		links[position] = last;
+		m_size--;
+
+		if (m_index)
+		{
+			// Dropped below half of the threshold, so that a port at the threshold doesn't rebuild the index on every edit
+			if (m_size < indexThreshold / 2)
+				m_index.reset();
+			else
+			{
+				m_index->erase(link);
+				if (position != m_size)
+					(*m_index)[last] = position;
+			}
+		}
+		return true;
+	}
+
+	void PortLinkList::clear() noexcept
+	{
+		if (onHeap())
+			delete[] m_heap;
+		m_size = 0;
+		m_capacity = inlineCapacity;
+		m_index.reset();
+	}
+
+	std::uint32_t PortLinkList::find(PortLink link) const
+	{
+		if (m_index)
+		{
+			auto found = m_index->find(link);
+			return (found != m_index->end()) ? found->second : m_size;
+		}
+
+		const PortLink* links = data();
+		for (std::uint32_t i = 0; i < m_size; i++)
+		{
+			if (links[i] == link)
+				return i;
+		}
+		return m_size;
+	}
+
+	void PortLinkList::grow()
+	{
+		const std::uint32_t capacity = m_capacity * 2;
+		PortLink* heap = new PortLink[capacity];
+		std::copy(begin(), end(), heap);
+		if (onHeap())
+			delete[] m_heap;
+
+		m_heap = heap;
+		m_capacity = capacity;
+	}
+
+#pragma endregion PortLinkList
+
+#pragma region PortTable
+
+	size_t PortTable::rowCount(PortDirection dir) const noexcept
+	{
+		return (dir == PortDirection::Input) ? m_inputOwners.size() : m_outputOwners.size();
+	}
+
+	bool PortTable::fragmented() const noexcept
+	{
+		// Small tables aren't worth the moves
+		constexpr size_t minRows = 1024;
+		auto mostlyFree = [](size_t freeRows, size_t rows) { return rows >= minRows && freeRows * 2 > rows; };
+		return mostlyFree(m_freeInputRows, m_inputOwners.size()) || mostlyFree(m_freeOutputRows, m_outputOwners.size());
+	}
+
+	void PortTable::compact()
+	{
+		for (auto dir : { PortDirection::Input, PortDirection::Output })
+		{
+			const auto& owners = (dir == PortDirection::Input) ? m_inputOwners : m_outputOwners;
+			std::uint32_t used = 0;
+			for (std::uint32_t row = 0; row < owners.size();)
+			{
+				Node* owner = owners[row];
+				if (owner == nullptr)
+				{
+					row++;
+					continue;
+				}
+
+				// The rows of a node are contiguous, so they are moved as a whole
+				const PortRange range = (dir == PortDirection::Input) ? owner->m_inputRange : owner->m_outputRange;
+				NF_ASSERT(range.first == row, "Rows of node are not contiguous");
+				if (row != used)
+				{
+					for (std::uint32_t i = 0; i < range.count; i++)
+						moveRow(dir, row + i, used + i);
+					owner->movePorts(dir, used);
+				}
+				row += range.count;
+				used += range.count;
+			}
+			resize(dir, used);
+		}
+		m_freeInputRows = 0;
+		m_freeOutputRows = 0;
+	}
+
+	std::uint32_t PortTable::appendRow(PortDirection dir, Node& owner)
+	{
+		PortRange& range = (dir == PortDirection::Input) ? owner.m_inputRange : owner.m_outputRange;
+		auto end = static_cast<std::uint32_t>(rowCount(dir));
+
+		// Another node added rows after those of 'owner', so they are moved behind them
+		if (range.count != 0 && range.first + range.count != end)
+		{
+			resize(dir, end + range.count);
+			for (std::uint32_t i = 0; i < range.count; i++)
+				moveRow(dir, range.first + i, end + i);
+
+			((dir == PortDirection::Input) ? m_freeInputRows : m_freeOutputRows) += range.count;
+			owner.movePorts(dir, end);
+			end += range.count;
+		}
+
+		if (range.count == 0)
+			range.first = end;
+		range.count++;
+
+		if (dir == PortDirection::Input)
+		{
+			m_inputTypes.emplace_back();
+			m_inputLinks.emplace_back();
+			m_inputOwners.push_back(&owner);
+			m_inputNames.emplace_back();
+		}
+		else
+		{
+			m_outputData.emplace_back();
+			m_outputColumns.emplace_back();
+			m_outputTypeOps.push_back(nullptr);
+			m_outputVersions.push_back(0);
+			m_outputLinks.emplace_back();
+			m_outputOwners.push_back(&owner);
+			m_outputNames.emplace_back();
+		}
+		return end;
+	}
+
+	void PortTable::releaseRows(PortDirection dir, Node& owner) noexcept
+	{
+		PortRange& range = (dir == PortDirection::Input) ? owner.m_inputRange : owner.m_outputRange;
+		if (range.count == 0)
+			return;
+
+		if (range.first + range.count == rowCount(dir))
+			resize(dir, range.first);
+		else
+		{
+			for (std::uint32_t i = 0; i < range.count; i++)
+				clearRow(dir, range.first + i);
+			((dir == PortDirection::Input) ? m_freeInputRows : m_freeOutputRows) += range.count;
+		}
+		range = PortRange{};
+	}
+
+	void PortTable::moveRow(PortDirection dir, std::uint32_t from, std::uint32_t to)
+	{
+		if (dir == PortDirection::Input)
+		{
+			m_inputTypes[to] = m_inputTypes[from];
+			m_inputLinks[to] = m_inputLinks[from];
+			m_inputOwners[to] = m_inputOwners[from];
+			m_inputNames[to] = m_inputNames[from];
+		}
+		else
+		{
+			m_outputData[to] = m_outputData[from];
+			m_outputColumns[to] = m_outputColumns[from];
+			m_outputTypeOps[to] = m_outputTypeOps[from];
+			m_outputVersions[to] = m_outputVersions[from];
+			m_outputLinks[to] = std::move(m_outputLinks[from]);
+			m_outputOwners[to] = m_outputOwners[from];
+			m_outputNames[to] = m_outputNames[from];
+		}
+		clearRow(dir, from);
+	}
+
+	void PortTable::clearRow(PortDirection dir, std::uint32_t row) noexcept
+	{
+		if (dir == PortDirection::Input)
+		{
+			m_inputTypes[row] = 0;
+			m_inputLinks[row].unlink();
+			m_inputOwners[row] = nullptr;
+			m_inputNames[row] = InternedName();
+		}
+		else
+		{
+			m_outputData[row].reset();
+			m_outputColumns[row] = detail::ColumnHandle{};
+			m_outputTypeOps[row] = nullptr;
+			m_outputVersions[row] = 0;
+			m_outputLinks[row].clear();
+			m_outputOwners[row] = nullptr;
+			m_outputNames[row] = InternedName();
+		}
+	}
+
+	void PortTable::resize(PortDirection dir, size_t rows)
+	{
+		if (dir == PortDirection::Input)
+		{
+			m_inputTypes.resize(rows);
+			m_inputLinks.resize(rows);
+			m_inputOwners.resize(rows);
+			m_inputNames.resize(rows);
+		}
+		else
+		{
+			m_outputData.resize(rows);
+			m_outputColumns.resize(rows);
+			m_outputTypeOps.resize(rows);
+			m_outputVersions.resize(rows);
+			m_outputLinks.resize(rows);
+			m_outputOwners.resize(rows);
+			m_outputNames.resize(rows);
+		}
+	}
+
+#pragma endregion PortTable
+
 #pragma region InputPortHandle
 
 	bool InputPortHandle::createLink(PortLink link)
@@ -53,19 +356,18 @@ namespace nf
 			NF_ASSERT(false, "Invalid Link");
 			return false;
 		}
-		m_link = link;
-		NF_ASSERT(m_link == link, "ERROR");
+		m_table->m_inputLinks[m_row] = link;
 		return true;
 	}
 
 	bool InputPortHandle::hasValidLink() const noexcept
 	{
-		return m_link.valid();
+		return link().valid();
 	}
 
 	void InputPortHandle::removeLink() noexcept
 	{
-		m_link.unlink();
+		m_table->m_inputLinks[m_row].unlink();
 	}
 
 #pragma endregion InputPortHandle
@@ -79,35 +381,28 @@ namespace nf
 			NF_ASSERT(false, "Invalid Link");
 			return false;
 		}
-		m_links.push_back(link);
+		m_table->m_outputLinks[m_row].push_back(link);
 		return true;
 	}
 
 	bool OutputPortHandle::removeLink(PortLink link)
 	{
-		auto iter = std::find(m_links.begin(), m_links.end(), link);
-		// found
-		if (iter != m_links.end())
-		{
-			m_links.erase(iter);
-			return true;
-		}
-		return false;
+		return m_table->m_outputLinks[m_row].erase(link);
 	}
 
 	bool OutputPortHandle::hasLink(PortLink link) const
 	{
-		return std::find(m_links.begin(), m_links.end(), link) != m_links.end();
+		return m_table->m_outputLinks[m_row].contains(link);
 	}
 
 	size_t OutputPortHandle::linkCount() const noexcept
 	{
-		return m_links.size();
+		return m_table->m_outputLinks[m_row].size();
 	}
 
 	void OutputPortHandle::breakAllLinks()
 	{
-		m_links.clear();
+		m_table->m_outputLinks[m_row].clear();
 	}
 
 #pragma endregion OutputPortHandle
@@ -34,19 +34,26 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 #include <string>
 #include <vector>
+#include <span>
+#include <string_view>
 #include <type_traits>
 #include <sstream>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
 
 
 #include "typedefs.hpp"
 #include "type_tricks.hpp"
 #include "../reflection/type_reflection.hpp"
 #include "core/DataHandle.hpp"
+#include "utility/NameTable.hpp"
 
 namespace nf
 {
 	class Node;
 	class FlowNode;
+	class ExecutionPlan;
 
 
 	enum class PortDirection
@@ -151,6 +158,7 @@ namespace nf
 
 	public:
 		T value{};
+		detail::ColumnBuffer<T> column; // Values in batch mode. Empty otherwise
 	};
 
 	template<>
@@ -257,15 +265,191 @@ namespace nf
 	};
 
 
+	/**
+	 * @brief Links of an output port. The first links are stored inline, so the common case of an output
+	 * with few consumers doesn't allocate. Once a port has many consumers, a hash index of the links is built,
+	 * so contains() and erase() stay constant time for ports with thousands of links.
+	 * The order of the links is not preserved by erase().
+	*/
+	class PortLinkList
+	{
+	public:
+		static constexpr std::uint32_t inlineCapacity = 3;
+		static constexpr std::uint32_t indexThreshold = 32; // Size from which on the hash index is kept
+
+		PortLinkList() noexcept {}
+		PortLinkList(const PortLinkList&) = delete;
+		PortLinkList(PortLinkList&& other) noexcept;
+		PortLinkList& operator=(const PortLinkList&) = delete;
+		PortLinkList& operator=(PortLinkList&& other) noexcept;
+		~PortLinkList();
+
+		inline const PortLink* begin() const noexcept { return data(); }
+		inline const PortLink* end() const noexcept { return data() + m_size; }
+		inline const PortLink& operator[](size_t index) const noexcept { return data()[index]; }
+		inline const PortLink& back() const noexcept { return data()[m_size - 1]; }
+		inline size_t size() const noexcept { return m_size; }
+		inline bool empty() const noexcept { return m_size == 0; }
+
+		/**
+		 * @brief Appends 'link', which must not be in the list yet
+		*/
+		void push_back(PortLink link);
+
+		bool contains(PortLink link) const;
+
+		/**
+		 * @brief Removes 'link' by moving the last link into its place
+		 * @return 'false' if 'link' is not in the list
+		*/
+		bool erase(PortLink link);
+
+		/**
+		 * @brief Removes all links and frees the heap memory of the list
+		*/
+		void clear() noexcept;
+
+	private:
+		struct LinkHash
+		{
+			size_t operator()(const PortLink& link) const noexcept;
+		};
+		using Index = std::unordered_map<PortLink, std::uint32_t, LinkHash>;
+
+		inline bool onHeap() const noexcept { return m_capacity > inlineCapacity; }
+		inline PortLink* data() noexcept { return onHeap() ? m_heap : m_inline; }
+		inline const PortLink* data() const noexcept { return onHeap() ? m_heap : m_inline; }
+
+		/**
+		 * @brief Returns the position of 'link' or 'm_size' if it's not in the list
+		*/
+		std::uint32_t find(PortLink link) const;
+
+		void grow();
+
+	private:
+		union
+		{
+			PortLink m_inline[inlineCapacity];
+			PortLink* m_heap;
+		};
+		std::uint32_t m_size = 0;
+		std::uint32_t m_capacity = inlineCapacity;
+		std::unique_ptr<Index> m_index; // Position of each link, only kept for lists with many links
+	};
+
+
+	class InputPortHandle;
+	class OutputPortHandle;
+
+	/**
+	 * @brief Contiguous rows of a PortTable holding the ports of one node in one direction
+	*/
+	struct PortRange
+	{
+		std::uint32_t first = 0;
+		std::uint32_t count = 0;
+	};
 
+	/**
+	 * @brief Stores the ports of many nodes column by column, one row per port. FlowScript keeps one table for all of its nodes.
+	 * Type ids, links, data handles and versions are packed in separate columns, so operations on the topology
+	 * stream through contiguous memory without touching the port names, which are only read by tools.
+	 * The ports of a node occupy one range of rows per direction, in port order.
+	*/
+	class PortTable
+	{
+		friend Node;
+		friend InputPortHandle;
+		friend OutputPortHandle;
+	public:
+		PortTable() = default;
+		PortTable(const PortTable&) = delete;
+		PortTable& operator=(const PortTable&) = delete;
+
+		/**
+		 * @brief Returns the number of rows, including the rows freed by removed nodes
+		*/
+		size_t rowCount(PortDirection dir) const noexcept;
+
+		/**
+		 * @brief Returns the links of all input rows. Freed rows hold invalid links.
+		*/
+		inline std::span<const PortLink> inputLinks() const noexcept { return m_inputLinks; }
+
+		/**
+		 * @brief Returns the links of all output rows
+		*/
+		inline std::span<const PortLinkList> outputLinks() const noexcept { return m_outputLinks; }
+
+		/**
+		 * @brief Returns the version counters of all output rows (see OutputPortHandle::version())
+		*/
+		inline std::span<const std::uint64_t> outputVersions() const noexcept { return m_outputVersions; }
+
+		/**
+		 * @brief 'true' if the rows freed by removed nodes make up most of the table
+		*/
+		bool fragmented() const noexcept;
+
+		/**
+		 * @brief Moves the rows of all nodes together and gives the freed rows back.
+		 * Port handles stay valid, only the rows they refer to change.
+		*/
+		void compact();
 
+	private:
+		/**
+		 * @brief Appends a row to the ports of 'owner'. The rows of 'owner' are moved to the end of the table first,
+		 * if other rows were added after them.
+		*/
+		std::uint32_t appendRow(PortDirection dir, Node& owner);
+
+		/**
+		 * @brief Frees all rows of 'owner' in direction 'dir'. They are given back by compact().
+		*/
+		void releaseRows(PortDirection dir, Node& owner) noexcept;
+
+		/**
+		 * @brief Moves row 'from' to 'to' and leaves 'from' as freed row
+		*/
+		void moveRow(PortDirection dir, std::uint32_t from, std::uint32_t to);
+
+		void clearRow(PortDirection dir, std::uint32_t row) noexcept;
+
+		void resize(PortDirection dir, size_t rows);
+
+	private:
+		std::vector<typeid_t> m_inputTypes;
+		std::vector<PortLink> m_inputLinks;
+		std::vector<Node*> m_inputOwners; // nullptr for freed rows
+
+		std::vector<detail::DataHandle> m_outputData;
+		std::vector<detail::ColumnHandle> m_outputColumns;
+		std::vector<const detail::TypeOps*> m_outputTypeOps;
+		std::vector<std::uint64_t> m_outputVersions;
+		std::vector<PortLinkList> m_outputLinks; // Output link to multiple nodes
+		std::vector<Node*> m_outputOwners;
+
+		// Cold columns
+		std::vector<InternedName> m_inputNames;
+		std::vector<InternedName> m_outputNames;
+
+		size_t m_freeInputRows = 0;
+		size_t m_freeOutputRows = 0;
+	};
+
+	/**
+	 * @brief Refers to the row of an input port in the PortTable of its node
+	*/
 	class InputPortHandle
 	{
 		friend Node;
+		friend PortTable;
 	public:
 		InputPortHandle() = default;
-		InputPortHandle( typeid_t typeID, const std::string& caption = "")
-			: m_name(caption), m_link(-1, nullptr), m_dataTypeID(typeID)
+		InputPortHandle(PortTable& table, std::uint32_t row)
+			: m_table(&table), m_row(row)
 		{}
 
 		bool createLink(PortLink link);
@@ -274,29 +458,37 @@ namespace nf
 
 		void removeLink() noexcept;
 
-		std::string name() const noexcept { return m_name; }
+		std::string_view name() const noexcept { return m_table->m_inputNames[m_row].view(); }
+
+		NameId nameId() const noexcept { return m_table->m_inputNames[m_row].id(); }
 
-		void setName(const std::string& name) { m_name = name; }
+		void setName(std::string_view name) { m_table->m_inputNames[m_row] = InternedName(name); }
 
-		PortLink link() const noexcept { return m_link; }
+		PortLink link() const noexcept { return m_table->m_inputLinks[m_row]; }
 		
-		inline typeid_t typeID() const noexcept { return m_dataTypeID; }
+		inline typeid_t typeID() const noexcept { return m_table->m_inputTypes[m_row]; }
+
+		/**
+		 * @brief Returns the row of the port in its PortTable. Changes when the table is compacted.
+		*/
+		inline std::uint32_t row() const noexcept { return m_row; }
 
 	private:
-		std::string m_name;
-		PortLink m_link;
-		typeid_t m_dataTypeID;
+		PortTable* m_table = nullptr;
+		std::uint32_t m_row = 0;
 	};
 
+	/**
+	 * @brief Refers to the row of an output port in the PortTable of its node
+	*/
 	class OutputPortHandle
 	{
 		friend Node;
+		friend PortTable;
 	public:
 		OutputPortHandle() = default;
-
-		template<typename T>
-		OutputPortHandle(T& data, typeid_t typeID, const std::string& caption = "")
-			: m_name(caption), m_dataHandle(data, typeID)
+		OutputPortHandle(PortTable& table, std::uint32_t row)
+			: m_table(&table), m_row(row)
 		{}
 
 		bool createLink(PortLink link);
@@ -309,27 +501,46 @@ namespace nf
 
 		void breakAllLinks();
 
-		std::string name() const noexcept { return m_name; }
+		std::string_view name() const noexcept { return m_table->m_outputNames[m_row].view(); }
 
-		void setName(const std::string& name) { m_name = name; }
+		NameId nameId() const noexcept { return m_table->m_outputNames[m_row].id(); }
 
-		const std::vector<PortLink>& links() const noexcept { return m_links; }
+		void setName(std::string_view name) { m_table->m_outputNames[m_row] = InternedName(name); }
+
+		const PortLinkList& links() const noexcept { return m_table->m_outputLinks[m_row]; }
 
 		template<typename T>
 		void setDataHandle(T& data, typeid_t typeID)
 		{
-			m_dataHandle.reset();
-			m_dataHandle.assign(data, typeID);
+			m_table->m_outputData[m_row].reset();
+			m_table->m_outputData[m_row].assign(data, typeID);
+			m_table->m_outputTypeOps[m_row] = &detail::typeOpsOf<T>();
 		}
 
-		inline const detail::DataHandle& dataHandle() const { return m_dataHandle; }
+		inline const detail::DataHandle& dataHandle() const { return m_table->m_outputData[m_row]; }
+
+		inline const detail::ColumnHandle& columnHandle() const { return m_table->m_outputColumns[m_row]; }
+
+		inline const detail::TypeOps* typeOps() const { return m_table->m_outputTypeOps[m_row]; }
+
+		inline typeid_t typeID() const noexcept { return m_table->m_outputData[m_row].typeID(); }
+
+		/**
+		 * @brief Returns a counter that is increased each time the value of the port changes.
+		 * Used to skip the re-evaluation of pure nodes whose inputs didn't change.
+		*/
+		inline std::uint64_t version() const noexcept { return m_table->m_outputVersions[m_row]; }
+
+		inline void markChanged() noexcept { m_table->m_outputVersions[m_row]++; }
 
-		inline typeid_t typeID() const noexcept { return m_dataHandle.typeID(); }
+		/**
+		 * @brief Returns the row of the port in its PortTable. Changes when the table is compacted.
+		*/
+		inline std::uint32_t row() const noexcept { return m_row; }
 
 	private:
-		std::string m_name;
-		std::vector<PortLink> m_links; // Output link to multiple nodes
-		detail::DataHandle m_dataHandle;
+		PortTable* m_table = nullptr;
+		std::uint32_t m_row = 0;
 	};
 
 
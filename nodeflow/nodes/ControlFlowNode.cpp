@@ -0,0 +1,21 @@
+#include "nodes/ControlFlowNode.hpp"
+
+namespace nf
+{
+
+	void ControlFlowNode::setAlternativeExit(FlowNode& node)
+	{
+		m_alternativeExit.execLink.makeLink(&node);
+	}
+
+	void ControlFlowNode::breakAlternativeExit()
+	{
+		m_alternativeExit.execLink.breakLink();
+	}
+
+	std::vector<FlowPort*> ControlFlowNode::additionalFlowPorts() const
+	{
+		return { const_cast<FlowPort*>(&m_alternativeExit) };
+	}
+
+}
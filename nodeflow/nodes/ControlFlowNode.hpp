@@ -0,0 +1,81 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+#include <vector>
+
+#include "typedefs.hpp"
+#include "core/Node.hpp"
+#include "nodes/FlowNode.hpp"
+
+namespace nf
+{
+	/**
+	 * @brief Base of nodes that select between two exits at runtime (ex. IfElse, loops).
+	 * The ExecutionPlan compiles them into a conditional jump. The default exit (setExecNext) is followed
+	 * unless process() selected the alternative exit. For loops, the alternative exit is the loop body,
+	 * whose end jumps back to the node.
+	*/
+	class ControlFlowNode : public FlowNode
+	{
+	public:
+		/**
+		 * @brief Returns 'true' if the alternative exit leads into a loop body that returns to this node
+		*/
+		virtual bool loops() const { return false; }
+
+		inline bool alternativeExitSelected() const noexcept { return m_alternativeSelected; }
+
+		inline FlowNode* alternativeExit() const noexcept { return m_alternativeExit.execLink.targetNode; }
+
+		void setAlternativeExit(FlowNode& node);
+
+		void breakAlternativeExit();
+
+		std::vector<FlowPort*> additionalFlowPorts() const override;
+
+	protected:
+		inline void selectExit(bool alternative) noexcept { m_alternativeSelected = alternative; }
+
+	private:
+		FlowPort m_alternativeExit;
+		bool m_alternativeSelected = false;
+	};
+
+	inline bool isControlFlowArchetype(NodeArchetype archetype) noexcept
+	{
+		return archetype == NodeArchetype::Lang_IfElse || archetype == NodeArchetype::Lang_WhileLoop ||
+			archetype == NodeArchetype::Lang_ForLoop;
+	}
+}
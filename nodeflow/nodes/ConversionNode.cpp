@@ -3,7 +3,7 @@
 namespace nf
 {
 
-	std::string ConversionNode::nodeName() const
+	std::string_view ConversionNode::nodeName() const
 	{
 		return "ConversionNode";
 	}
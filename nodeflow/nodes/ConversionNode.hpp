@@ -33,6 +33,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #pragma once
 
+#include <format>
+
 #include "typedefs.hpp"
 #include "nodes/FlowNode.hpp"
 
@@ -49,7 +51,7 @@ namespace nf
 	class ConversionNode : public FlowNode
 	{
 	public:
-		std::string nodeName() const override;
+		std::string_view nodeName() const override;
 
 		NodeArchetype getArchetype() const final;
 
@@ -61,19 +63,32 @@ namespace nf
 	class ConversionNodeImpl : public ConversionNode
 	{
 	public:
-		static std::string staticNodeName;
-		static std::string staticInputPortName;
-		static std::string staticOutputPortName;
+		static InternedName staticNodeName;
+		static InternedName staticInputPortName;
+		static InternedName staticOutputPortName;
 
 	public:
 		ConversionNodeImpl();
 
-		std::string nodeName() const override;
+		std::string_view nodeName() const override;
 
-		std::string portName(PortDirection dir, PortIndex index) const override;
+		std::string_view portName(PortDirection dir, PortIndex index) const override;
 
 		Expected<void, Error> setup() override;
 
+		/**
+		 * @brief Rejects an unconnected input, the thunks read it without checking
+		*/
+		Expected<void, Error> onBuild() override;
+
+		bool isPure() const override { return true; }
+
+		ProcessThunk processThunk() const override { return &ConversionNodeImpl::invokeBound; }
+
+		BatchThunk batchThunk() const override { return &ConversionNodeImpl::invokeBatch; }
+
+		InstanceThunk instanceThunk() const override { return &ConversionNodeImpl::invokeInstance; }
+
 		bool streamOutput(PortIndex index, StreamFlag flag, std::stringstream& archive) final;
 
 		void process() override
@@ -85,19 +100,44 @@ namespace nf
 				m_toPort.value = ConversionCallable(*input);
 		}
 
+	private:
+		static void invokeBound(Node* self, void* const* inputs)
+		{
+			auto& node = static_cast<ConversionNodeImpl&>(*self);
+			node.m_toPort.value = ConversionCallable(*static_cast<const FromType*>(inputs[0]));
+		}
+
+		static void invokeInstance(const Node* self, std::byte* values, const std::uint32_t* offsets)
+		{
+			NF_UNUSED(self);
+			*reinterpret_cast<ToType*>(values + offsets[1]) = ConversionCallable(*reinterpret_cast<const FromType*>(values + offsets[0]));
+		}
+
+		static void invokeBatch(Node* self, const ColumnView* inputs, size_t count)
+		{
+			auto& node = static_cast<ConversionNodeImpl&>(*self);
+			node.m_toPort.column.resize(count);
+
+			ToType* out = node.m_toPort.column.data();
+			const FromType* in = static_cast<const FromType*>(inputs[0].data);
+			const size_t stride = inputs[0].stride;
+			for (size_t i = 0; i < count; i++)
+				out[i] = ConversionCallable(in[i * stride]);
+		}
+
 	private:
 		nf::InputPort<FromType> m_fromPort;
 		nf::OutputPort<ToType> m_toPort;
 	};
 
 	template<typename FromType, typename ToType, auto ConversionCallable>
-	std::string ConversionNodeImpl<FromType, ToType, ConversionCallable>::staticNodeName = "ConversionNodeImpl";
+	InternedName ConversionNodeImpl<FromType, ToType, ConversionCallable>::staticNodeName{ "ConversionNodeImpl" };
 
 	template<typename FromType, typename ToType, auto ConversionCallable>
-	std::string ConversionNodeImpl<FromType, ToType, ConversionCallable>::staticInputPortName = "Input";
+	InternedName ConversionNodeImpl<FromType, ToType, ConversionCallable>::staticInputPortName{ "Input" };
 
 	template<typename FromType, typename ToType, auto ConversionCallable>
-	std::string ConversionNodeImpl<FromType, ToType, ConversionCallable>::staticOutputPortName = "Output";
+	InternedName ConversionNodeImpl<FromType, ToType, ConversionCallable>::staticOutputPortName{ "Output" };
 
 	template<typename FromType, typename ToType, auto ConversionCallable>
 	ConversionNodeImpl<FromType, ToType, ConversionCallable>::ConversionNodeImpl()
@@ -108,14 +148,14 @@ namespace nf
 	}
 
 	template<typename FromType, typename ToType, auto ConversionCallable>
-	std::string ConversionNodeImpl<FromType, ToType, ConversionCallable>::nodeName() const
+	std::string_view ConversionNodeImpl<FromType, ToType, ConversionCallable>::nodeName() const
 	{
 		return staticNodeName;
 	}
 
 
 	template<typename FromType, typename ToType, auto ConversionCallable>
-	std::string ConversionNodeImpl<FromType, ToType, ConversionCallable>::portName(PortDirection dir, PortIndex index) const
+	std::string_view ConversionNodeImpl<FromType, ToType, ConversionCallable>::portName(PortDirection dir, PortIndex index) const
 	{
 		NF_ASSERT(index == 0, "ConversionNodeImpl only has 1 input and 1 output");
 		if (dir == PortDirection::Input)
@@ -132,6 +172,14 @@ namespace nf
 		return {};
 	}
 
+	template<typename FromType, typename ToType, auto ConversionCallable>
+	Expected<void, Error> ConversionNodeImpl<FromType, ToType, ConversionCallable>::onBuild()
+	{
+		if (!m_inputPorts[0].link().valid())
+			return make_unexpected(Error(std::format("Build failed for Node '{}': input not connected", nodeName()), 120));
+		return {};
+	}
+
 	template<typename FromType, typename ToType, auto ConversionCallable>
 	bool ConversionNodeImpl<FromType, ToType, ConversionCallable>::streamOutput(PortIndex index, StreamFlag flag, std::stringstream& archive)
 	{
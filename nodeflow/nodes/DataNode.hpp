@@ -126,7 +126,7 @@ namespace nf
 	class DataNodeImpl : public DataNode
 	{
 	public:
-		static std::string staticNodeName;
+		static InternedName staticNodeName;
 
 	public:
 		DataNodeImpl();
@@ -134,7 +134,7 @@ namespace nf
 
 		Expected<void, Error> setup() override;
 
-		std::string nodeName() const override;
+		std::string_view nodeName() const override;
 
 		bool streamOutput(PortIndex index, StreamFlag flag, std::stringstream& archive) final;
 
@@ -144,14 +144,18 @@ namespace nf
 
 		inline const Type& data() const noexcept { return m_data.value; }
 
-		inline void setData(Type&& data) noexcept { m_data.value = std::forward<Type>(data); }
+		inline void setData(Type&& data) noexcept 
+		{ 
+			m_data.value = std::forward<Type>(data); 
+			markOutputChanged(m_data.index());
+		}
 
 	private:
 		OutputPort<Type> m_data;
 	};
 
 	template <typename Type>
-	std::string DataNodeImpl<Type>::staticNodeName = "DataNode";
+	InternedName DataNodeImpl<Type>::staticNodeName{ "DataNode" };
 
 
 	template<typename Type>
@@ -180,7 +184,7 @@ namespace nf
 	}
 
 	template<typename Type>
-	std::string DataNodeImpl<Type>::nodeName() const
+	std::string_view DataNodeImpl<Type>::nodeName() const
 	{
 		return staticNodeName;
 	}
@@ -9,7 +9,7 @@ namespace nf
 		allocateExpectedPortCount(PortDirection::Output, 0);
 	}
 
-	std::string StartEventNode::nodeName() const
+	std::string_view StartEventNode::nodeName() const
 	{
 		return "StartEventNode";
 	}
@@ -46,7 +46,7 @@ namespace nf
 	public:
 		StartEventNode();
 
-		std::string nodeName() const override;
+		std::string_view nodeName() const override;
 
 		Expected<void, Error> setup() override;
 
@@ -91,7 +91,11 @@ namespace nf
 		void constructFromEvent(const EventType& event) override
 		{
 			if constexpr (hasFields)
+			{
 				std::apply([&event](auto&&... port) { ((port.value = std::invoke(MemAccessers, event)), ...); }, m_eventFields);
+				for (size_t i = 0; i < this->m_outputPorts.size(); i++)
+					this->markOutputChanged(static_cast<PortIndex>(i));
+			}
 		}
 
 		bool setFieldNames(const std::vector<std::string_view>& fieldNames)
@@ -107,7 +111,7 @@ namespace nf
 				for (size_t i = 0; i < this->m_outputPorts.size(); i++)
 				{
 					auto& oPort = this->m_outputPorts[i];
-					oPort.setName(std::string(fieldNames[i]));
+					oPort.setName(fieldNames[i]);
 				}
 
 				return true;
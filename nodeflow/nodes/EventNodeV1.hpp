@@ -93,7 +93,7 @@ namespace nf {
 				for (size_t i = 0; i < m_outputPorts.size(); i++)
 				{
 					auto& oPort = m_outputPorts[i];
-					oPort.setName(std::string(fieldNames[i]));
+					oPort.setName(fieldNames[i]);
 				}
 
 				return true;
@@ -8,13 +8,6 @@ namespace nf
 		return NodeArchetype::FlowNode;
 	}
 
-	bool FlowNode::onEvent(FlowEvent* event)
-	{
-		NF_UNUSED(event);
-		std::cout << ("FlowEvent") << " \n";
-		return false;
-	}
-
 	void FlowNode::breakFlow(FlowDirection dir)
 	{
 		if (dir == FlowDirection::Next)
@@ -41,7 +34,7 @@ namespace nf
 		return {};
 	}
 
-	std::string FlowNode::flowPortName(FlowDirection dir, PortIndex index) const
+	std::string_view FlowNode::flowPortName(FlowDirection dir, PortIndex index) const
 	{
 		NF_UNUSED(index);
 		NF_UNUSED(dir);
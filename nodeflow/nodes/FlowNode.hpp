@@ -51,8 +51,6 @@ namespace nf
 	public:
 		NodeArchetype getArchetype() const override;
 
-		bool onEvent(FlowEvent* event) override;
-
 		inline void setExecNext(FlowNode& next) { m_outExecPort.execLink.makeLink(&next); forceNextExec(next); }
 
 		inline void setExecBefore(FlowNode& before)  {  m_inExecPort.execLink.makeLink(&before); }
@@ -73,7 +71,10 @@ namespace nf
 
 		virtual std::vector<FlowPort*> additionalFlowPorts() const;
 
-		virtual std::string flowPortName(FlowDirection dir, PortIndex index) const;
+		/**
+		 * @brief Returns the name of a flow port. 'index' 0 is the default port, additional flow ports follow.
+		*/
+		virtual std::string_view flowPortName(FlowDirection dir, PortIndex index) const;
 
 	private:
 		FlowPort m_inExecPort;
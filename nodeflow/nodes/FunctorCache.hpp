@@ -0,0 +1,194 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+#include <list>
+#include <tuple>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <concepts>
+#include <functional>
+#include <unordered_map>
+
+#include "typedefs.hpp"
+
+namespace nf
+{
+	template<typename T>
+	concept Memoizable = std::equality_comparable<T> && requires(const T& value)
+	{
+		{ std::hash<T>{}(value) } -> std::convertible_to<size_t>;
+	};
+
+	/**
+	 * @brief Bounded least-recently-used cache that maps the arguments of a pure function to its result.
+	 * Shared by all FunctorNodes of the same function, and therefore guarded by a mutex.
+	 * Lookups take the arguments by reference, they are only copied when a result is inserted.
+	 * A cache with capacity 0 returns before taking the mutex.
+	*/
+	template<typename Result, typename... Args>
+	class FunctorCache
+	{
+	public:
+		using Key = std::tuple<Args...>;
+		using ArgumentRefs = std::tuple<const Args&...>;
+		static constexpr size_t DefaultCapacity = 128;
+
+	public:
+		FunctorCache() = default;
+
+		/**
+		 * @brief Copies the cached result for 'arguments' into 'result' and marks the entry as most recently used.
+		 * @return 'false' if there is no entry for 'arguments'
+		*/
+		bool tryGet(const ArgumentRefs& arguments, Result& result)
+		{
+			if (m_capacity.load(std::memory_order_relaxed) == 0)
+				return false;
+
+			std::lock_guard lock(m_mutex);
+			auto found = m_index.find(arguments);
+			if (found == m_index.end())
+			{
+				m_misses++;
+				return false;
+			}
+
+			m_entries.splice(m_entries.begin(), m_entries, found->second);
+			result = found->second->second;
+			m_hits++;
+			return true;
+		}
+
+		/**
+		 * @brief Adds a result to the cache. Evicts the least recently used entry if the capacity is exceeded.
+		*/
+		void insert(const ArgumentRefs& arguments, const Result& result)
+		{
+			if (m_capacity.load(std::memory_order_relaxed) == 0)
+				return;
+
+			std::lock_guard lock(m_mutex);
+			if (m_index.contains(arguments))
+				return;
+
+			m_entries.emplace_front(Key(arguments), result);
+			m_index.emplace(std::cref(m_entries.front().first), m_entries.begin());
+			evictExceeding();
+		}
+
+		void setCapacity(size_t capacity)
+		{
+			std::lock_guard lock(m_mutex);
+			m_capacity = capacity;
+			evictExceeding();
+		}
+
+		void clear()
+		{
+			std::lock_guard lock(m_mutex);
+			m_index.clear();
+			m_entries.clear();
+			m_hits = 0;
+			m_misses = 0;
+		}
+
+		size_t capacity() const { return m_capacity.load(std::memory_order_relaxed); }
+
+		size_t size() const { std::lock_guard lock(m_mutex); return m_entries.size(); }
+
+		std::uint64_t hits() const { std::lock_guard lock(m_mutex); return m_hits; }
+
+		std::uint64_t misses() const { std::lock_guard lock(m_mutex); return m_misses; }
+
+	private:
+		using Entry = std::pair<Key, Result>;
+		using KeyRef = std::reference_wrapper<const Key>;
+
+		static const Key& unwrap(const Key& key) { return key; }
+		static const Key& unwrap(const KeyRef& key) { return key.get(); }
+		static const ArgumentRefs& unwrap(const ArgumentRefs& arguments) { return arguments; }
+
+		// Transparent, so lookups don't have to copy the arguments into a Key
+		struct KeyHash
+		{
+			using is_transparent = void;
+
+			template<typename KeyLike>
+			size_t operator()(const KeyLike& key) const
+			{
+				return std::apply([](const auto&... arg) {
+					size_t seed = 0;
+					((seed ^= std::hash<std::decay_t<decltype(arg)>>{}(arg) + 0x9e3779b9 + (seed << 6) + (seed >> 2)), ...);
+					return seed;
+				}, unwrap(key));
+			}
+		};
+
+		struct KeyEqual
+		{
+			using is_transparent = void;
+
+			template<typename Lhs, typename Rhs>
+			bool operator()(const Lhs& lhs, const Rhs& rhs) const { return unwrap(lhs) == unwrap(rhs); }
+		};
+
+		void evictExceeding()
+		{
+			while (m_entries.size() > m_capacity)
+			{
+				m_index.erase(std::cref(m_entries.back().first));
+				m_entries.pop_back();
+			}
+		}
+
+	private:
+		mutable std::mutex m_mutex;
+		std::list<Entry> m_entries; // Front is the most recently used entry
+		std::unordered_map<KeyRef, typename std::list<Entry>::iterator, KeyHash, KeyEqual> m_index;
+		std::atomic<size_t> m_capacity = DefaultCapacity; // Written under the mutex, read without it to skip a disabled cache
+		std::uint64_t m_hits = 0;
+		std::uint64_t m_misses = 0;
+	};
+
+	template<typename Result, typename ArgumentTuple>
+	struct functor_cache_for;
+
+	template<typename Result, typename... Args>
+	struct functor_cache_for<Result, std::tuple<Args...>>
+	{
+		using type = FunctorCache<Result, std::decay_t<Args>...>;
+		static constexpr bool memoizable = (Memoizable<std::decay_t<Args>> && ...);
+	};
+}
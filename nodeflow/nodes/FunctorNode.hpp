@@ -35,23 +35,64 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <vector>
 #include <string>
 #include <format>
+#include <span>
 
 #include "typedefs.hpp"
 #include "core/Node.hpp"
 #include "nodes/FlowNode.hpp"
+#include "nodes/FunctorCache.hpp"
 #include "core/type_tricks.hpp"
 
 
 
 namespace nf
 {
+	/**
+	 * @brief Declares whether a registered function depends solely on its arguments.
+	 * Pure functions may be skipped if their inputs didn't change, folded if they only read constants
+	 * and removed if nothing observes their results.
+	 * Results of Purity::Pure functions are additionally cached in FunctorNode<func>::resultCache(), which is
+	 * consulted by FlowScript::run() and FlowInstance::run(), but not in batch mode.
+	*/
+	enum class Purity
+	{
+		Impure,
+		Pure,
+		PureUncached	// For functions that are cheaper to recompute than to look up in the cache
+	};
+
+	/**
+	 * @brief Signature of a kernel processing whole columns in batch mode: (std::span<Result> out, std::span<const Args>... in).
+	 * Kernels of functions without result only receive the input spans.
+	*/
+	template<typename Result, typename ArgsTuple>
+	struct batch_kernel_for;
+
+	template<typename Result, typename... Args>
+	struct batch_kernel_for<Result, std::tuple<Args...>>
+	{
+		using type = void(*)(std::span<Result>, std::span<const std::decay_t<Args>>...);
+	};
+
+	template<typename... Args>
+	struct batch_kernel_for<void, std::tuple<Args...>>
+	{
+		using type = void(*)(std::span<const std::decay_t<Args>>...);
+	};
+
 	template<auto Func>
 	class FunctorNode : public FlowNode
 	{
 	public:
-		static std::string staticNodeName;
-		static std::string staticResultPortName;
-		static std::vector<std::string> staticArgPortNames;
+		using BatchKernel_t = typename batch_kernel_for<typename FuncSignature<decltype(std::function{ Func })>::ReturnType_t,
+			typename FuncSignature<decltype(std::function{ Func })>::ParamTypes_t>::type;
+
+		static InternedName staticNodeName;
+		static InternedName staticResultPortName;
+		static std::vector<InternedName> staticArgPortNames;
+		static Purity staticPurity;
+		static BatchKernel_t staticBatchKernel;	// Optional, used in batch mode if all inputs are columns
+		static NativeSymbol staticNativeSymbol;	// Optional, required to export the node as native code
 
 
 	public:
@@ -63,10 +104,25 @@ namespace nf
 		static constexpr bool hasInputs = std::tuple_size_v<InputPorts_t> != 0;
 		static constexpr bool hasOutput = !std::is_void_v<FReturn_t>;
 
+		using ResultCache_t = typename functor_cache_for<FReturn_t, FArgument_ts>::type;
+		// Results can only be cached if all arguments are hashable and equality comparable
+		static constexpr bool memoizable = hasInputs && hasOutput && functor_cache_for<FReturn_t, FArgument_ts>::memoizable;
+
+		/**
+		 * @brief Returns the result cache shared by all nodes and instances of this function.
+		 * Only used if the function was registered as Purity::Pure.
+		*/
+		static ResultCache_t& resultCache()
+		{
+			static_assert(memoizable, "Function arguments must be hashable and equality comparable");
+			static ResultCache_t cache;
+			return cache;
+		}
+
 	public:
 
 
-		std::string nodeName() const override
+		std::string_view nodeName() const override
 		{
 			return staticNodeName;
 		}
@@ -76,13 +132,18 @@ namespace nf
 			return NodeArchetype::Flow_FunctorNode;
 		}
 
-		std::string portName(PortDirection dir, PortIndex index) const override
+		bool isPure() const override
+		{
+			return staticPurity != Purity::Impure;
+		}
+
+		std::string_view portName(PortDirection dir, PortIndex index) const override
 		{
 			if (dir == PortDirection::Input)
 			{
 				NF_ASSERT(index < m_inputPorts.size(), "Port index out of range");
 				if (!(index < staticArgPortNames.size()))
-					return "";
+					return {};
 				return staticArgPortNames.at(index);
 			}
 
@@ -159,15 +220,44 @@ namespace nf
 			return {};
 		}
 
+		ProcessThunk processThunk() const override
+		{
+			if constexpr (memoizable)
+			{
+				if (staticPurity == Purity::Pure)
+					return &FunctorNode::invokeMemoized;
+			}
+			return &FunctorNode::invokeBound;
+		}
+
+		BatchThunk batchThunk() const override
+		{
+			return &FunctorNode::invokeBatch;
+		}
+
+		InstanceThunk instanceThunk() const override
+		{
+			return &FunctorNode::invokeInstance;
+		}
+
+		const NativeSymbol* nativeSymbol() const override
+		{
+			return staticNativeSymbol.name.empty() ? nullptr : &staticNativeSymbol;
+		}
+
 		void process() override
 		{
-			// Move to onCompile() / inBuild() override to save performance;
-			for (const auto& port : m_inputPorts)
-				NF_ASSERT(port.link().valid(), "InputPort not connected");
-			
+			// Connections of all inputs are validated in onBuild()
 
 			if constexpr (hasInputs && hasOutput)
+			{
+				if constexpr (memoizable)
+				{
+					if (staticPurity == Purity::Pure)
+						return processMemoized();
+				}
 				m_resultPort.value = applyPortsOnCallable(Func, m_argumentPorts);
+			}
 
 			else if constexpr (hasInputs && !hasOutput)
 				applyPortsOnCallable(Func, m_argumentPorts);
@@ -180,6 +270,148 @@ namespace nf
 
 		}
 
+	private:
+		// Calls Func directly on the input pointers bound by the ExecutionPlan.
+		// No virtual dispatch, link validation or typeid comparison involved.
+		static void invokeBound(Node* self, void* const* inputs)
+		{
+			auto& node = static_cast<FunctorNode&>(*self);
+			constexpr auto argCount = std::tuple_size_v<InputPorts_t>;
+
+			if constexpr (hasOutput)
+				node.m_resultPort.value = invokeOnInputs(inputs, std::make_index_sequence<argCount>{});
+			else
+				invokeOnInputs(inputs, std::make_index_sequence<argCount>{});
+		}
+
+		static void invokeMemoized(Node* self, void* const* inputs)
+		{
+			auto& node = static_cast<FunctorNode&>(*self);
+			invokeCached(node.m_resultPort.value, referenceInputs(inputs, std::make_index_sequence<std::tuple_size_v<InputPorts_t>>{}));
+		}
+
+		static void invokeInstance(const Node* self, std::byte* values, const std::uint32_t* offsets)
+		{
+			NF_UNUSED(self);
+			constexpr auto argCount = std::tuple_size_v<InputPorts_t>;
+
+			if constexpr (hasOutput)
+			{
+				auto& result = *reinterpret_cast<FReturn_t*>(values + offsets[argCount]);
+				if constexpr (memoizable)
+				{
+					// Instances of a FlowGraph share the cache, like the nodes of different scripts
+					if (staticPurity == Purity::Pure)
+						return invokeCached(result, referenceValues(values, offsets, std::make_index_sequence<argCount>{}));
+				}
+				result = invokeOnValues(values, offsets, std::make_index_sequence<argCount>{});
+			}
+			else
+				invokeOnValues(values, offsets, std::make_index_sequence<argCount>{});
+		}
+
+		template<size_t... seq>
+		static decltype(auto) invokeOnValues(const std::byte* values, const std::uint32_t* offsets, std::index_sequence<seq...>)
+		{
+			NF_UNUSED(values);
+			NF_UNUSED(offsets);
+			return std::invoke(Func, *reinterpret_cast<const std::decay_t<std::tuple_element_t<seq, FArgument_ts>>*>(values + offsets[seq])...);
+		}
+
+		static void invokeBatch(Node* self, const ColumnView* inputs, size_t count)
+		{
+			auto& node = static_cast<FunctorNode&>(*self);
+			FReturn_t* out = nullptr;
+			if constexpr (hasOutput)
+			{
+				node.m_resultPort.column.resize(count);
+				out = node.m_resultPort.column.data();
+			}
+			invokeOnColumns(out, inputs, count, std::make_index_sequence<std::tuple_size_v<InputPorts_t>>{});
+		}
+
+		template<size_t I>
+		using Argument_t = std::decay_t<std::tuple_element_t<I, FArgument_ts>>;
+
+		template<size_t... seq>
+		static void invokeOnColumns([[maybe_unused]] FReturn_t* out, const ColumnView* inputs, size_t count, std::index_sequence<seq...>)
+		{
+			NF_UNUSED(inputs);
+			const bool contiguous = ((inputs[seq].stride == 1) && ...);
+
+			if (contiguous)
+			{
+				if (staticBatchKernel != nullptr)
+				{
+					if constexpr (hasOutput)
+						staticBatchKernel(std::span<FReturn_t>(out, count), std::span<const Argument_t<seq>>(static_cast<const Argument_t<seq>*>(inputs[seq].data), count)...);
+					else
+						staticBatchKernel(std::span<const Argument_t<seq>>(static_cast<const Argument_t<seq>*>(inputs[seq].data), count)...);
+					return;
+				}
+
+				// Unit stride, simple enough for the compiler to vectorize
+				const auto columns = std::make_tuple(static_cast<const Argument_t<seq>*>(inputs[seq].data)...);
+				for (size_t i = 0; i < count; i++)
+				{
+					if constexpr (hasOutput)
+						out[i] = std::invoke(Func, std::get<seq>(columns)[i]...);
+					else
+						std::invoke(Func, std::get<seq>(columns)[i]...);
+				}
+				return;
+			}
+
+			for (size_t i = 0; i < count; i++)
+			{
+				if constexpr (hasOutput)
+					out[i] = std::invoke(Func, static_cast<const Argument_t<seq>*>(inputs[seq].data)[i * inputs[seq].stride]...);
+				else
+					std::invoke(Func, static_cast<const Argument_t<seq>*>(inputs[seq].data)[i * inputs[seq].stride]...);
+			}
+		}
+
+		template<size_t... seq>
+		static decltype(auto) invokeOnInputs(void* const* inputs, std::index_sequence<seq...>)
+		{
+			NF_UNUSED(inputs);
+			return std::invoke(Func, *static_cast<const std::decay_t<std::tuple_element_t<seq, FArgument_ts>>*>(inputs[seq])...);
+		}
+
+		void processMemoized()
+		{
+			invokeCached(m_resultPort.value, referencePorts(std::make_index_sequence<std::tuple_size_v<InputPorts_t>>{}));
+		}
+
+		// The arguments are only copied into the cache on a miss
+		template<typename Result, typename ArgumentRefs>
+		static void invokeCached(Result& result, const ArgumentRefs& arguments)
+		{
+			if (resultCache().tryGet(arguments, result))
+				return;
+
+			result = std::apply(Func, arguments);
+			resultCache().insert(arguments, result);
+		}
+
+		template<size_t... seq>
+		auto referencePorts(std::index_sequence<seq...>) const
+		{
+			return std::forward_as_tuple(static_cast<const Argument_t<seq>&>(*getInputData(std::get<seq>(m_argumentPorts)))...);
+		}
+
+		template<size_t... seq>
+		static auto referenceInputs(void* const* inputs, std::index_sequence<seq...>)
+		{
+			return std::forward_as_tuple(*static_cast<const Argument_t<seq>*>(inputs[seq])...);
+		}
+
+		template<size_t... seq>
+		static auto referenceValues(const std::byte* values, const std::uint32_t* offsets, std::index_sequence<seq...>)
+		{
+			return std::forward_as_tuple(*reinterpret_cast<const Argument_t<seq>*>(values + offsets[seq])...);
+		}
+
 	public:
 		InputPorts_t m_argumentPorts;
 		OutputPort<FReturn_t> m_resultPort;
@@ -187,14 +419,23 @@ namespace nf
 	};
 
 	template<auto Func>
-	std::string FunctorNode<Func>::staticNodeName = "FunctorNode";
+	InternedName FunctorNode<Func>::staticNodeName{ "FunctorNode" };
 
 	
 	template<auto Func>
-	std::string FunctorNode<Func>::staticResultPortName = "Result";
+	InternedName FunctorNode<Func>::staticResultPortName{ "Result" };
+
+	template<auto Func>
+	std::vector<InternedName> FunctorNode<Func>::staticArgPortNames;
+
+	template<auto Func>
+	Purity FunctorNode<Func>::staticPurity = Purity::Impure;
+
+	template<auto Func>
+	typename FunctorNode<Func>::BatchKernel_t FunctorNode<Func>::staticBatchKernel = nullptr;
 
 	template<auto Func>
-	std::vector<std::string> FunctorNode<Func>::staticArgPortNames;
+	NativeSymbol FunctorNode<Func>::staticNativeSymbol;
 
 
 }
\ No newline at end of file
@@ -22,22 +22,42 @@ namespace nf
 		return {};
 	}
 
+	Expected<void, Error> IfElseNode::onBuild()
+	{
+		if (!m_inputPorts[0].link().valid())
+			return make_unexpected(Error(std::format("Build failed for Node '{}': condition not connected", nodeName()), 120));
+		return {};
+	}
+
 	void IfElseNode::process()
 	{
 		auto cond = getInputData(m_condition);
+		selectExit(cond == nullptr || !*cond);
+	}
 
-		if (cond == nullptr)
-			return;
+	std::string_view IfElseNode::portName(PortDirection dir, PortIndex index) const
+	{
+		NF_UNUSED(index);
+		return (dir == PortDirection::Input) ? "Condition" : "";
 	}
 
-	void IfElseNode::setExecFlowIf(FlowNode& node)
+	std::string_view IfElseNode::flowPortName(FlowDirection dir, PortIndex index) const
 	{
+		if (dir == FlowDirection::Before)
+			return {};
+		return (index == 0) ? "True" : "False";
+	}
 
+	void IfElseNode::setExecFlowIf(FlowNode& node)
+	{
+		setExecNext(node);
+		node.setExecBefore(*this);
 	}
 
 	void IfElseNode::setExecFlowElse(FlowNode& node)
 	{
-
+		setAlternativeExit(node);
+		node.setExecBefore(*this);
 	}
 
 }
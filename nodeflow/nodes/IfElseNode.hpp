@@ -35,12 +35,15 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "typedefs.hpp"
 #include "core/Node.hpp"
-#include "nodes/FlowNode.hpp"
+#include "nodes/ControlFlowNode.hpp"
 
 
 namespace nf
 {
-	class IfElseNode : public FlowNode
+	/**
+	 * @brief Continues the flow at the 'True' exit (default) or the 'False' exit depending on its condition
+	*/
+	class IfElseNode : public ControlFlowNode
 	{
 	public:
 
@@ -53,16 +56,19 @@ namespace nf
 
 		Expected<void, Error> setup() override;
 
+		Expected<void, Error> onBuild() override;
+
 		void process() override;
 
+		std::string_view portName(PortDirection dir, PortIndex index) const override;
+
+		std::string_view flowPortName(FlowDirection dir, PortIndex index) const override;
+
 		void setExecFlowIf(FlowNode& node);
 
 		void setExecFlowElse(FlowNode& node);
 
 	private:
 		InputPort<bool> m_condition;
-		ExecutionLink m_linkExitElse;
-
-		
 	};
 }
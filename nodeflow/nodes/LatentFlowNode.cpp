@@ -0,0 +1,54 @@
+#include "nodes/LatentFlowNode.hpp"
+
+namespace nf
+{
+
+	NodeArchetype LatentFlowNode::getArchetype() const
+	{
+		return NodeArchetype::Flow_LatentNode;
+	}
+
+	void LatentFlowNode::process()
+	{
+		NF_ASSERT(!suspended(), "LatentFlowNode processed again while suspended");
+		m_task = processLatent();
+		if (m_task.done())
+			completeLatent();
+	}
+
+	LatentFlowNode::DelayAwaiter LatentFlowNode::delay(Clock::duration duration) const
+	{
+		NF_ASSERT(m_latentQueue, "LatentFlowNode is not part of a built FlowScript");
+		return DelayAwaiter{ m_latentQueue, Clock::now() + duration };
+	}
+
+	void LatentFlowNode::completeLatent()
+	{
+		LatentTask task = std::move(m_task);
+		task.rethrowIfFailed();
+	}
+
+	void LatentFlowNode::cancelLatent()
+	{
+		m_task.reset();
+	}
+
+	Expected<void, Error> DelayNode::setup()
+	{
+		addPort(m_seconds);
+		return {};
+	}
+
+	std::string_view DelayNode::portName(PortDirection dir, PortIndex index) const
+	{
+		NF_UNUSED(index);
+		return (dir == PortDirection::Input) ? "Seconds" : "";
+	}
+
+	LatentTask DelayNode::processLatent()
+	{
+		const double* seconds = getInputData(m_seconds);
+		if (seconds && *seconds > 0.0)
+			co_await delay(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(*seconds)));
+	}
+}
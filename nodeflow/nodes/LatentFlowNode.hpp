@@ -0,0 +1,279 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+#include <chrono>
+#include <optional>
+#include <coroutine>
+#include <exception>
+#include <type_traits>
+#include <variant>
+
+#include "typedefs.hpp"
+#include "nodes/FlowNode.hpp"
+#include "script/LatentQueue.hpp"
+
+namespace nf
+{
+	/**
+	 * @brief Coroutine returned by LatentFlowNode::processLatent().
+	 * Starts eagerly and runs until its first suspension. Owns the coroutine frame.
+	*/
+	class LatentTask
+	{
+	public:
+		struct promise_type
+		{
+			std::exception_ptr exception;
+
+			LatentTask get_return_object() { return LatentTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_always final_suspend() noexcept { return {}; }
+			void return_void() noexcept {}
+			void unhandled_exception() noexcept { exception = std::current_exception(); }
+		};
+
+	public:
+		LatentTask() = default;
+
+		explicit LatentTask(std::coroutine_handle<promise_type> handle)
+			: m_handle(handle)
+		{}
+
+		LatentTask(LatentTask&& other) noexcept
+			: m_handle(std::exchange(other.m_handle, nullptr))
+		{}
+
+		LatentTask& operator=(LatentTask&& other) noexcept
+		{
+			if (this != &other)
+			{
+				reset();
+				m_handle = std::exchange(other.m_handle, nullptr);
+			}
+			return *this;
+		}
+
+		~LatentTask() { reset(); }
+
+		inline bool done() const noexcept { return !m_handle || m_handle.done(); }
+
+		/**
+		 * @brief Rethrows an exception that escaped the coroutine body
+		*/
+		void rethrowIfFailed() const
+		{
+			if (m_handle && m_handle.promise().exception)
+				std::rethrow_exception(m_handle.promise().exception);
+		}
+
+		void reset() noexcept
+		{
+			if (m_handle)
+				m_handle.destroy();
+			m_handle = nullptr;
+		}
+
+	private:
+		std::coroutine_handle<promise_type> m_handle;
+	};
+
+	/**
+	 * @brief FlowNode whose work may suspend, ex. to wait for a timer, an event or IO.
+	 * The owning FlowScript parks its execution at this node while the coroutine is suspended and
+	 * continues with the following nodes once it completed. Resumption happens in FlowScript::update(),
+	 * so the coroutine body always runs on the thread driving the script.
+	 * Latent nodes require ExecutionPolicy::Sequential and don't support batch execution.
+	*/
+	class LatentFlowNode : public FlowNode
+	{
+	public:
+		using Clock = LatentQueue::Clock;
+
+		/**
+		 * @brief Awaitable resuming after a duration
+		*/
+		struct DelayAwaiter
+		{
+			LatentQueue* queue;
+			Clock::time_point deadline;
+
+			bool await_ready() const noexcept { return Clock::now() >= deadline; }
+			void await_suspend(std::coroutine_handle<> handle) { queue->resumeAt(deadline, handle); }
+			void await_resume() const noexcept {}
+		};
+
+		/**
+		 * @brief Awaitable resuming once an event of type 'EventType' was broadcast by the script. Yields a copy of the event.
+		*/
+		template<typename EventType>
+		struct EventAwaiter
+		{
+			LatentQueue* queue;
+			std::optional<EventType> event;
+
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<> handle) { queue->resumeOnEvent(EventType::type, &EventAwaiter::accept, this, handle); }
+			EventType await_resume() { return std::move(*event); }
+
+			static void accept(void* awaiter, const FlowEvent& event)
+			{
+				static_cast<EventAwaiter*>(awaiter)->event.emplace(static_cast<const EventType&>(event));
+			}
+		};
+
+		/**
+		 * @brief Awaitable running 'work' on the async pool of the script. Yields its result.
+		 * Exceptions thrown by 'work' are rethrown in the coroutine.
+		*/
+		template<typename Work>
+		struct AsyncAwaiter
+		{
+			using Result_t = std::invoke_result_t<Work&>;
+			using Storage_t = std::conditional_t<std::is_void_v<Result_t>, std::monostate, Result_t>;
+
+			LatentQueue* queue;
+			Work work;
+			std::optional<Storage_t> result;
+			std::exception_ptr exception;
+			std::coroutine_handle<> handle;
+
+			bool await_ready() const noexcept { return false; }
+
+			void await_suspend(std::coroutine_handle<> h)
+			{
+				handle = h;
+				queue->submitAsync({ &AsyncAwaiter::invoke, this, 0 });
+			}
+
+			Result_t await_resume()
+			{
+				if (exception)
+					std::rethrow_exception(exception);
+				if constexpr (!std::is_void_v<Result_t>)
+					return std::move(*result);
+			}
+
+			static void invoke(void* context, std::uint32_t)
+			{
+				auto& self = *static_cast<AsyncAwaiter*>(context);
+				try
+				{
+					if constexpr (std::is_void_v<Result_t>)
+					{
+						self.work();
+						self.result.emplace();
+					}
+					else
+						self.result.emplace(self.work());
+				}
+				catch (...)
+				{
+					self.exception = std::current_exception();
+				}
+				self.queue->finishAsync(self.handle);
+			}
+		};
+
+	public:
+		NodeArchetype getArchetype() const final;
+
+		/**
+		 * @brief Starts processLatent(). Use processLatent() to implement the node.
+		*/
+		void process() final;
+
+		/**
+		 * @brief Coroutine implementing the node. Values of the output ports must be written before it completes.
+		*/
+		virtual LatentTask processLatent() = 0;
+
+		/**
+		 * @brief Returns 'true' while the coroutine started by the last process() hasn't completed
+		*/
+		inline bool suspended() const noexcept { return !m_task.done(); }
+
+	protected:
+		DelayAwaiter delay(Clock::duration duration) const;
+
+		template<typename EventType>
+		EventAwaiter<EventType> waitForEvent() const
+		{
+			NF_ASSERT(m_latentQueue, "LatentFlowNode is not part of a built FlowScript");
+			return EventAwaiter<EventType>{ m_latentQueue, std::nullopt };
+		}
+
+		template<typename Work>
+		AsyncAwaiter<std::decay_t<Work>> runAsync(Work&& work) const
+		{
+			NF_ASSERT(m_latentQueue, "LatentFlowNode is not part of a built FlowScript");
+			return AsyncAwaiter<std::decay_t<Work>>{ m_latentQueue, std::forward<Work>(work) };
+		}
+
+	private:
+		friend class FlowScript;
+
+		/**
+		 * @brief Releases the completed coroutine. Rethrows its exception, if any.
+		*/
+		void completeLatent();
+
+		/**
+		 * @brief Destroys a suspended coroutine without resuming it
+		*/
+		void cancelLatent();
+
+	private:
+		LatentQueue* m_latentQueue = nullptr;
+		LatentTask m_task;
+	};
+
+	/**
+	 * @brief Continues the flow after a number of seconds
+	*/
+	class DelayNode : public LatentFlowNode
+	{
+	public:
+		NF_NODE_NAME("Delay");
+
+		Expected<void, Error> setup() override;
+
+		std::string_view portName(PortDirection dir, PortIndex index) const override;
+
+		LatentTask processLatent() override;
+
+	private:
+		InputPort<double> m_seconds;
+	};
+}
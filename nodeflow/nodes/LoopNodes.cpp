@@ -0,0 +1,146 @@
+#include "nodes/LoopNodes.hpp"
+
+namespace nf
+{
+	namespace
+	{
+		Expected<void, Error> validateInputs(const Node& node)
+		{
+			for (const auto& iPort : node.getInputPortList())
+			{
+				if (!iPort.link().valid())
+					return make_unexpected(Error(std::format("Build failed for Node '{}': one or more InputPort(s) not connected ", node.nodeName()), 120));
+			}
+			return {};
+		}
+
+		std::string_view loopFlowPortName(FlowDirection dir, PortIndex index)
+		{
+			if (dir == FlowDirection::Before)
+				return {};
+			return (index == 0) ? "Completed" : "Body";
+		}
+	}
+
+	WhileLoopNode::WhileLoopNode()
+	{
+		allocateExpectedPortCount(PortDirection::Input, 1);
+		allocateExpectedPortCount(PortDirection::Output, 0);
+	}
+
+	NodeArchetype WhileLoopNode::getArchetype() const
+	{
+		return NodeArchetype::Lang_WhileLoop;
+	}
+
+	Expected<void, Error> WhileLoopNode::setup()
+	{
+		addPort(m_condition);
+		return {};
+	}
+
+	Expected<void, Error> WhileLoopNode::onBuild()
+	{
+		return validateInputs(*this);
+	}
+
+	void WhileLoopNode::process()
+	{
+		auto cond = getInputData(m_condition);
+		selectExit(cond != nullptr && *cond);
+	}
+
+	std::string_view WhileLoopNode::portName(PortDirection dir, PortIndex index) const
+	{
+		NF_UNUSED(index);
+		return (dir == PortDirection::Input) ? "Condition" : "";
+	}
+
+	std::string_view WhileLoopNode::flowPortName(FlowDirection dir, PortIndex index) const
+	{
+		return loopFlowPortName(dir, index);
+	}
+
+	void WhileLoopNode::setExecFlowBody(FlowNode& node)
+	{
+		setAlternativeExit(node);
+		node.setExecBefore(*this);
+	}
+
+	void WhileLoopNode::setExecFlowCompleted(FlowNode& node)
+	{
+		setExecNext(node);
+		node.setExecBefore(*this);
+	}
+
+	ForLoopNode::ForLoopNode()
+	{
+		allocateExpectedPortCount(PortDirection::Input, 2);
+		allocateExpectedPortCount(PortDirection::Output, 1);
+	}
+
+	NodeArchetype ForLoopNode::getArchetype() const
+	{
+		return NodeArchetype::Lang_ForLoop;
+	}
+
+	Expected<void, Error> ForLoopNode::setup()
+	{
+		addPort(m_first);
+		addPort(m_last);
+		addPort(m_index);
+		return {};
+	}
+
+	Expected<void, Error> ForLoopNode::onBuild()
+	{
+		// A previous execution might have been cancelled within the body
+		m_running = false;
+		return validateInputs(*this);
+	}
+
+	void ForLoopNode::process()
+	{
+		auto first = getInputData(m_first);
+		auto last = getInputData(m_last);
+
+		if (!m_running)
+		{
+			m_index.value = *first;
+			m_running = (*first <= *last);
+		}
+		else
+		{
+			// Compared before incrementing, so 'Last' may be the maximum of int
+			m_running = (m_index.value < *last);
+			if (m_running)
+				m_index.value++;
+		}
+		selectExit(m_running);
+	}
+
+	std::string_view ForLoopNode::portName(PortDirection dir, PortIndex index) const
+	{
+		if (dir == PortDirection::Output)
+			return "Index";
+		return (index == 0) ? "First" : "Last";
+	}
+
+	std::string_view ForLoopNode::flowPortName(FlowDirection dir, PortIndex index) const
+	{
+		return loopFlowPortName(dir, index);
+	}
+
+	void ForLoopNode::setExecFlowBody(FlowNode& node)
+	{
+		setAlternativeExit(node);
+		node.setExecBefore(*this);
+	}
+
+	void ForLoopNode::setExecFlowCompleted(FlowNode& node)
+	{
+		setExecNext(node);
+		node.setExecBefore(*this);
+	}
+
+}
@@ -0,0 +1,114 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "typedefs.hpp"
+#include "core/Node.hpp"
+#include "nodes/ControlFlowNode.hpp"
+
+
+namespace nf
+{
+	/**
+	 * @brief Runs the flow at its 'Body' exit as long as the condition holds, then continues at 'Completed' (default).
+	 * The condition and its data dependencies are re-evaluated before every iteration.
+	*/
+	class WhileLoopNode : public ControlFlowNode
+	{
+	public:
+		NF_NODE_NAME("WhileLoop")
+
+	public:
+		WhileLoopNode();
+
+		NodeArchetype getArchetype() const override;
+
+		bool loops() const override { return true; }
+
+		Expected<void, Error> setup() override;
+
+		Expected<void, Error> onBuild() override;
+
+		void process() override;
+
+		std::string_view portName(PortDirection dir, PortIndex index) const override;
+
+		std::string_view flowPortName(FlowDirection dir, PortIndex index) const override;
+
+		void setExecFlowBody(FlowNode& node);
+
+		void setExecFlowCompleted(FlowNode& node);
+
+	private:
+		InputPort<bool> m_condition;
+	};
+
+	/**
+	 * @brief Runs the flow at its 'Body' exit once for every index in [First, Last], then continues at 'Completed' (default).
+	 * The current index is provided by the 'Index' output.
+	*/
+	class ForLoopNode : public ControlFlowNode
+	{
+	public:
+		NF_NODE_NAME("ForLoop")
+
+	public:
+		ForLoopNode();
+
+		NodeArchetype getArchetype() const override;
+
+		bool loops() const override { return true; }
+
+		Expected<void, Error> setup() override;
+
+		Expected<void, Error> onBuild() override;
+
+		void process() override;
+
+		std::string_view portName(PortDirection dir, PortIndex index) const override;
+
+		std::string_view flowPortName(FlowDirection dir, PortIndex index) const override;
+
+		void setExecFlowBody(FlowNode& node);
+
+		void setExecFlowCompleted(FlowNode& node);
+
+	private:
+		InputPort<int> m_first;
+		InputPort<int> m_last;
+		OutputPort<int> m_index;
+		bool m_running = false; // Loop was entered and m_index holds the index of the last iteration
+	};
+}
@@ -0,0 +1,530 @@
+#include "script/ExecutionPlan.hpp"
+#include "core/Node.hpp"
+#include "nodes/FlowNode.hpp"
+#include "nodes/LatentFlowNode.hpp"
+#include "nodes/ControlFlowNode.hpp"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+namespace nf
+{
+	struct ExecutionPlan::FlowCompilation
+	{
+		NodeSet chain;							// Every flow node reachable from the entry
+		NodeSet scheduled;
+		std::vector<const Node*> stack;			// Data dependencies currently being scheduled
+		std::vector<const FlowNode*> path;		// Flow nodes leading to the current one
+		NodeSet onPath;							// Same nodes as 'path', for constant time cycle checks
+		std::map<std::pair<const FlowNode*, std::int32_t>, std::int32_t> entries; // (node, exit) -> first step
+	};
+
+	ExecutionPlan::~ExecutionPlan()
+	{
+		clear();
+	}
+
+	Expected<void, Error> ExecutionPlan::compile(FlowNode& entry)
+	{
+		clear();
+
+		// Collect all flow nodes reachable from the entry first. Nodes on the chain are executed in flow
+		// order and must never be scheduled a second time as data dependency of another node.
+		FlowCompilation state;
+		state.chain.insert(&entry);
+		std::vector<FlowNode*> pending{ entry.getExecNext() };
+		while (!pending.empty())
+		{
+			FlowNode* node = pending.back();
+			pending.pop_back();
+			if (node == nullptr || !state.chain.insert(node).second)
+				continue;
+
+			pending.push_back(node->getExecNext());
+			for (FlowPort* port : node->additionalFlowPorts())
+				pending.push_back(port->execLink.targetNode);
+		}
+
+		if (auto success = compileFlow(entry.getExecNext(), -1, state); !success)
+		{
+			clear();
+			return make_unexpected(success.error());
+		}
+
+		NodeSet distinct;
+		for (const auto& step : m_steps)
+		{
+			if (distinct.insert(step.node).second)
+				m_nodes.push_back(step.node);
+		}
+
+		bindInputs();
+		m_seenVersions.assign(m_inputs.size(), 0);
+		m_columns.assign(m_inputs.size(), ColumnView{});
+		m_evaluated.assign(m_steps.size(), 0);
+		m_compiled = true;
+		return {};
+	}
+
+	void ExecutionPlan::clear()
+	{
+		for (Node* node : m_nodes)
+			node->m_boundInputs = nullptr;
+
+		m_steps.clear();
+		m_inputs.clear();
+		m_inputSources.clear();
+		m_seenVersions.clear();
+		m_columns.clear();
+		m_evaluated.clear();
+		m_nodes.clear();
+		m_foldedSteps.clear();
+		m_constantSources.clear();
+		m_constantVersions.clear();
+		m_compiled = false;
+	}
+
+	std::int32_t ExecutionPlan::run(std::int32_t pc /*= 0*/) const
+	{
+		if (m_steps.empty())
+			return -1;
+
+		while (pc != -1)
+		{
+			execute(static_cast<std::uint32_t>(pc));
+
+			const ExecutionStep& step = m_steps[pc];
+			if (step.latent && static_cast<const LatentFlowNode*>(step.node)->suspended())
+				return pc;
+
+			if (step.branch && static_cast<const ControlFlowNode*>(step.node)->alternativeExitSelected())
+				pc = step.jump;
+			else
+				pc = step.next;
+		}
+		return -1;
+	}
+
+	bool ExecutionPlan::hasLatentSteps() const noexcept
+	{
+		return std::any_of(m_steps.begin(), m_steps.end(), [](const ExecutionStep& step) { return step.latent; });
+	}
+
+	bool ExecutionPlan::hasBranchSteps() const noexcept
+	{
+		return std::any_of(m_steps.begin(), m_steps.end(), [](const ExecutionStep& step) { return step.branch; });
+	}
+
+	void ExecutionPlan::execute(std::uint32_t stepIndex) const
+	{
+		const ExecutionStep& step = m_steps[stepIndex];
+		Node* node = step.node;
+
+		if (m_incremental && node->isPure() && !inputsChanged(stepIndex))
+			return;
+
+		invoke(step);
+
+		// Values of all outputs might have changed
+		node->markAllOutputsChanged();
+	}
+
+	void ExecutionPlan::invoke(const ExecutionStep& step) const
+	{
+		if (m_profiler == nullptr)
+			return step.thunk(step.node, m_inputs.data() + step.firstInput);
+
+		const auto begin = Profiler::now();
+		step.thunk(step.node, m_inputs.data() + step.firstInput);
+		m_profiler->record(step.node, begin, Profiler::now());
+	}
+
+	Expected<void, Error> ExecutionPlan::runBatch(size_t count) const
+	{
+		// Validate up front, a partially executed batch would leave the columns in an inconsistent state
+		for (const auto& step : m_steps)
+		{
+			if (step.batchThunk == nullptr)
+				return make_unexpected(Error(std::format("Node '{}' doesn't support batch execution", step.node->nodeName()), 132));
+		}
+
+		// Variables read by folded steps may provide one value per record
+		for (const auto& step : m_foldedSteps)
+		{
+			if (auto success = executeBatch(step, count); !success)
+				return success;
+		}
+
+		std::int32_t pc = m_steps.empty() ? -1 : 0;
+		while (pc != -1)
+		{
+			const ExecutionStep& step = m_steps[pc];
+			if (auto success = executeBatch(step, count); !success)
+				return success;
+
+			pc = step.next;
+		}
+		return {};
+	}
+
+	Expected<void, Error> ExecutionPlan::executeBatch(const ExecutionStep& step, size_t count) const
+	{
+		if (auto success = resolveColumns(step, count); !success)
+			return success;
+
+		const auto begin = (m_profiler != nullptr) ? Profiler::now() : Profiler::Clock::time_point{};
+		step.batchThunk(step.node, m_columns.data() + step.firstInput, count);
+		if (m_profiler != nullptr)
+			m_profiler->record(step.node, begin, Profiler::now());
+
+		step.node->markAllOutputsChanged();
+		return {};
+	}
+
+	Expected<void, Error> ExecutionPlan::resolveColumns(const ExecutionStep& step, size_t count) const
+	{
+		for (auto i = step.firstInput; i < step.firstInput + step.inputCount; i++)
+		{
+			const OutputPortHandle* source = m_inputSources[i];
+			if (source == nullptr)
+			{
+				m_columns[i] = ColumnView{};
+				continue;
+			}
+
+			const size_t rows = source->columnHandle().size();
+			if (rows == 0)
+				m_columns[i] = ColumnView{ source->dataHandle().data(), 0 };
+			else if (rows >= count)
+				m_columns[i] = ColumnView{ source->columnHandle().data(), 1 };
+			else
+				return make_unexpected(Error(std::format("Input column of Node '{}' holds {} of {} records",
+					step.node->nodeName(), rows, count), 133));
+		}
+		return {};
+	}
+
+	void ExecutionPlan::foldConstants()
+	{
+		// Nodes are folded in evaluation order. A node is only folded once all of its sources are constant,
+		// which takes multiple passes if a loop or branch placed a source behind its reader.
+		NodeSet folded;
+		std::vector<std::uint32_t> foldOrder;
+		for (bool changed = true; changed;)
+		{
+			changed = false;
+			for (std::uint32_t i = 0; i < m_steps.size(); i++)
+			{
+				const Node* node = m_steps[i].node;
+				if (!node->isPure() || folded.contains(node))
+					continue;
+
+				const auto links = node->inputLinks();
+				const bool constant = std::all_of(links.begin(), links.end(), [&](const PortLink& link) {
+					return link.valid() && (folded.contains(link.targetNode) || isConstantVariable(*link.targetNode));
+				});
+
+				if (constant)
+				{
+					folded.insert(node);
+					foldOrder.push_back(i);
+					changed = true;
+				}
+			}
+		}
+
+		if (folded.empty())
+			return;
+
+		for (auto index : foldOrder)
+		{
+			const ExecutionStep& step = m_steps[index];
+			m_foldedSteps.push_back(step);
+
+			for (const PortLink& link : step.node->inputLinks())
+			{
+				const OutputPortHandle* source = &link.targetNode->m_outputPorts[link.targetIndex];
+				if (!folded.contains(link.targetNode) && std::find(m_constantSources.begin(), m_constantSources.end(), source) == m_constantSources.end())
+					m_constantSources.push_back(source);
+			}
+		}
+		m_constantVersions.assign(m_constantSources.size(), 0);
+
+		removeSteps(folded);
+		evaluateFolded();
+	}
+
+	std::vector<Node*> ExecutionPlan::eliminateDeadNodes(const std::unordered_set<const OutputPortHandle*>& observed)
+	{
+		// Nodes with side effects are live. So is every node computing an input of a live node or an observed port.
+		NodeSet live;
+		std::vector<const Node*> pending;
+		for (const Node* node : m_nodes)
+		{
+			const bool observedOutput = std::any_of(node->m_outputPorts.begin(), node->m_outputPorts.end(),
+				[&observed](const OutputPortHandle& oPort) { return observed.contains(&oPort); });
+
+			if ((!node->isPure() || observedOutput) && live.insert(node).second)
+				pending.push_back(node);
+		}
+
+		while (!pending.empty())
+		{
+			const Node* node = pending.back();
+			pending.pop_back();
+
+			for (const PortLink& link : node->inputLinks())
+			{
+				if (link.valid() && live.insert(link.targetNode).second)
+					pending.push_back(link.targetNode);
+			}
+		}
+
+		NodeSet dead;
+		std::vector<Node*> pruned;
+		for (Node* node : m_nodes)
+		{
+			if (live.contains(node))
+				continue;
+
+			dead.insert(node);
+			pruned.push_back(node);
+			node->m_boundInputs = nullptr;
+		}
+
+		if (!dead.empty())
+		{
+			removeSteps(dead);
+			std::erase_if(m_nodes, [&dead](const Node* node) { return dead.contains(node); });
+		}
+		return pruned;
+	}
+
+	void ExecutionPlan::removeSteps(const NodeSet& nodes)
+	{
+		// Every step continuing at a removed one continues at its first remaining successor.
+		// Only pure nodes are removed, which never branch. So following 'next' always leads to a remaining step or to the end.
+		std::vector<std::int32_t> remap(m_steps.size(), -1);
+		std::vector<ExecutionStep> remaining;
+		for (std::uint32_t i = 0; i < m_steps.size(); i++)
+		{
+			if (!nodes.contains(m_steps[i].node))
+			{
+				remap[i] = static_cast<std::int32_t>(remaining.size());
+				remaining.push_back(m_steps[i]);
+			}
+		}
+
+		auto resolve = [&](std::int32_t target) {
+			while (target != -1 && remap[target] == -1)
+				target = m_steps[target].next;
+			return (target == -1) ? -1 : remap[target];
+		};
+
+		NF_ASSERT(m_steps.empty() || resolve(0) == -1 || resolve(0) == 0, "Plan must start at its first remaining step");
+		for (auto& step : remaining)
+		{
+			step.next = resolve(step.next);
+			step.jump = resolve(step.jump);
+		}
+
+		m_steps = std::move(remaining);
+		m_evaluated.assign(m_steps.size(), 0);
+	}
+
+	void ExecutionPlan::refreshConstants() const
+	{
+		for (size_t i = 0; i < m_constantSources.size(); i++)
+		{
+			if (m_constantSources[i]->version() != m_constantVersions[i])
+				return evaluateFolded();
+		}
+	}
+
+	bool ExecutionPlan::isConstantVariable(const Node& node) const
+	{
+		if (node.getArchetype() != NodeArchetype::DataNode)
+			return false;
+
+		// Any reader that is not pure might write to the variable (ex. DataSetterNode)
+		for (const auto& oPort : node.m_outputPorts)
+		{
+			for (const PortLink& link : oPort.links())
+			{
+				if (!link.targetNode->isPure())
+					return false;
+			}
+		}
+		return true;
+	}
+
+	void ExecutionPlan::evaluateFolded() const
+	{
+		for (const auto& step : m_foldedSteps)
+		{
+			step.thunk(step.node, m_inputs.data() + step.firstInput);
+
+			step.node->markAllOutputsChanged();
+		}
+
+		for (size_t i = 0; i < m_constantSources.size(); i++)
+			m_constantVersions[i] = m_constantSources[i]->version();
+	}
+
+	void ExecutionPlan::setIncremental(bool incremental)
+	{
+		m_incremental = incremental;
+		std::fill(m_evaluated.begin(), m_evaluated.end(), std::uint8_t(0));
+	}
+
+	Expected<std::int32_t, Error> ExecutionPlan::compileFlow(FlowNode* first, std::int32_t exit, FlowCompilation& state)
+	{
+		// Straight flows are compiled iteratively, only the alternative exits of ControlFlowNodes recurse
+		const size_t pathDepth = state.path.size();
+		std::int32_t firstStep = exit;
+		std::int32_t previous = -1;
+
+		auto linkPrevious = [&](std::int32_t target) {
+			if (previous == -1)
+				firstStep = target;
+			else
+				m_steps[previous].next = target;
+		};
+
+		auto leavePath = [&]() {
+			for (size_t i = pathDepth; i < state.path.size(); i++)
+				state.onPath.erase(state.path[i]);
+			state.path.resize(pathDepth);
+		};
+
+		for (FlowNode* node = first; node != nullptr; node = node->getExecNext())
+		{
+			if (state.onPath.contains(node))
+				return make_unexpected(Error(std::format("Execution flow contains a cycle at Node '{}'", node->nodeName()), 130));
+
+			// Flows merging into an already compiled node continue at its steps
+			if (auto found = state.entries.find({ node, exit }); found != state.entries.end())
+			{
+				linkPrevious(found->second);
+				leavePath();
+				return firstStep;
+			}
+
+			const auto entry = static_cast<std::int32_t>(m_steps.size());
+			linkPrevious(entry);
+			state.entries.emplace(std::make_pair(node, exit), entry);
+			state.path.push_back(node);
+			state.onPath.insert(node);
+
+			// Dependencies are re-evaluated for each flow node, as a previous flow node might
+			// have changed their inputs (ex. DataSetterNode).
+			state.scheduled.clear();
+			if (auto success = scheduleDependencies(*node, state.chain, state.scheduled, state.stack); !success)
+				return make_unexpected(success.error());
+
+			appendStep(*node);
+			previous = static_cast<std::int32_t>(m_steps.size() - 1);
+			m_steps[previous].next = exit;
+
+			if (m_steps[previous].branch)
+			{
+				auto control = static_cast<ControlFlowNode*>(node);
+				// The end of a loop body jumps back to the dependencies of the loop node, which re-evaluates them
+				const std::int32_t alternativeExit = control->loops() ? entry : exit;
+				auto jump = compileFlow(control->alternativeExit(), alternativeExit, state);
+				if (!jump)
+					return jump;
+				m_steps[previous].jump = *jump;
+			}
+		}
+
+		leavePath();
+		return firstStep;
+	}
+
+	Expected<void, Error> ExecutionPlan::scheduleDependencies(Node& node, const NodeSet& chain, NodeSet& scheduled, std::vector<const Node*>& stack)
+	{
+		for (const PortLink& link : node.inputLinks())
+		{
+			if (!link.valid())
+				continue;
+
+			Node* source = link.targetNode;
+			// Variables hold their value and flow nodes were already executed in flow order
+			if (source->getArchetype() == NodeArchetype::DataNode || chain.contains(source) || scheduled.contains(source))
+				continue;
+
+			if (std::find(stack.begin(), stack.end(), source) != stack.end())
+				return make_unexpected(Error(std::format("Data dependencies of Node '{}' contain a cycle", source->nodeName()), 131));
+
+			stack.push_back(source);
+			auto success = scheduleDependencies(*source, chain, scheduled, stack);
+			stack.pop_back();
+
+			if (!success)
+				return success;
+
+			scheduled.insert(source);
+			appendStep(*source);
+		}
+		return {};
+	}
+
+	void ExecutionPlan::appendStep(Node& node)
+	{
+		ExecutionStep step;
+		step.node = &node;
+		step.thunk = node.processThunk();
+		step.batchThunk = node.batchThunk();
+		step.latent = (node.getArchetype() == NodeArchetype::Flow_LatentNode);
+		step.branch = isControlFlowArchetype(node.getArchetype());
+		step.firstInput = static_cast<std::uint32_t>(m_inputs.size());
+		step.inputCount = static_cast<std::uint32_t>(node.m_inputPorts.size());
+		step.next = static_cast<std::int32_t>(m_steps.size() + 1);
+
+		for (const PortLink& link : node.inputLinks())
+		{
+			if (!link.valid())
+			{
+				m_inputs.push_back(nullptr);
+				m_inputSources.push_back(nullptr);
+				continue;
+			}
+			const auto& sourcePort = link.targetNode->m_outputPorts[link.targetIndex];
+			m_inputs.push_back(sourcePort.dataHandle().m_dataptr);
+			m_inputSources.push_back(&sourcePort);
+		}
+
+		m_steps.push_back(step);
+	}
+
+	void ExecutionPlan::bindInputs()
+	{
+		// m_inputs is final at this point, so pointers into it stay valid until clear()
+		for (const auto& step : m_steps)
+		{
+			if (step.inputCount != 0)
+				step.node->m_boundInputs = &m_inputs[step.firstInput];
+		}
+	}
+
+	bool ExecutionPlan::inputsChanged(std::uint32_t stepIndex) const
+	{
+		const ExecutionStep& step = m_steps[stepIndex];
+		bool changed = (m_evaluated[stepIndex] == 0);
+		m_evaluated[stepIndex] = 1;
+
+		for (auto i = step.firstInput; i < step.firstInput + step.inputCount; i++)
+		{
+			if (m_inputSources[i] == nullptr || m_inputSources[i]->version() == m_seenVersions[i])
+				continue;
+
+			m_seenVersions[i] = m_inputSources[i]->version();
+			changed = true;
+		}
+		return changed;
+	}
+
+}
@@ -0,0 +1,241 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+#include <vector>
+#include <unordered_set>
+#include <cstdint>
+
+#include "typedefs.hpp"
+#include "core/Node.hpp"
+#include "core/Error.hpp"
+#include "utility/Expected.hpp"
+#include "script/Profiler.hpp"
+
+namespace nf
+{
+	class FlowNode;
+
+	enum class ExecutionPolicy
+	{
+		Sequential,
+		Parallel
+	};
+
+	/**
+	 * @brief Single entry of a compiled ExecutionPlan.
+	 * Holds everything needed to execute a node without walking its links.
+	*/
+	struct ExecutionStep
+	{
+		Node* node = nullptr;
+		ProcessThunk thunk = nullptr;
+		BatchThunk batchThunk = nullptr;
+		bool latent = false;			// Node is a LatentFlowNode and may suspend the execution
+		bool branch = false;			// Node is a ControlFlowNode and selects between 'next' and 'jump'
+		std::uint32_t firstInput = 0;	// Offset of the node's resolved inputs within ExecutionPlan::m_inputs
+		std::uint32_t inputCount = 0;
+		std::int32_t next = -1;			// Step executed afterwards. -1 ends the execution
+		std::int32_t jump = -1;			// Alternative target for nodes that branch the flow
+	};
+
+	/**
+	 * @brief Flat, contiguous representation of the execution flow of a FlowScript.
+	 * Built from the ExecutionLink chain starting at the StartEventNode. Data dependencies of
+	 * a flow node that are not part of the chain themselves are scheduled right before it.
+	 * ControlFlowNodes become conditional jumps. The end of a loop body jumps back to the
+	 * dependencies of its loop node, so no part of the graph is walked again while iterating.
+	*/
+	class ExecutionPlan
+	{
+	public:
+		ExecutionPlan() = default;
+		~ExecutionPlan();
+
+		ExecutionPlan(const ExecutionPlan&) = delete;
+		ExecutionPlan& operator=(const ExecutionPlan&) = delete;
+
+		/**
+		 * @brief Compiles the flow starting after 'entry' into a linear array of steps
+		 * and binds the resolved input pointers to the scheduled nodes.
+		 * @return nothing or an Error if the flow contains a cycle
+		*/
+		Expected<void, Error> compile(FlowNode& entry);
+
+		/**
+		 * @brief Removes pure nodes from the plan whose outputs never reach a node with side effects or a port in 'observed'.
+		 * Flow nodes other than pure FunctorNodes and ConversionNodes always have side effects.
+		 * @return the removed nodes. They are no longer part of nodes().
+		*/
+		std::vector<Node*> eliminateDeadNodes(const std::unordered_set<const OutputPortHandle*>& observed);
+
+		/**
+		 * @brief Evaluates pure nodes that only read constant variables once and removes their steps from the plan.
+		 * A DataNode counts as constant if every node reading it is pure, so no DataSetterNode writes to it.
+		 * Must be called after every scheduled node was validated via Node::onBuild().
+		*/
+		void foldConstants();
+
+		/**
+		 * @brief Re-evaluates the folded nodes if a variable they read was changed from outside
+		 * (ex. DataNode::setData) since they were last evaluated.
+		*/
+		void refreshConstants() const;
+
+		/**
+		 * @brief Unbinds all scheduled nodes and releases the plan.
+		 * Must be called before any node of the plan is destroyed or relinked.
+		*/
+		void clear();
+
+		/**
+		 * @brief Executes the steps of the plan, starting at step 'pc'.
+		 * Stops early if a LatentFlowNode suspended. Its successors are executed by resuming at the step's 'next'.
+		 * @return index of the suspended step or -1 if the execution finished
+		*/
+		std::int32_t run(std::int32_t pc = 0) const;
+
+		/**
+		 * @brief Returns 'true' if any step of the plan may suspend the execution
+		*/
+		bool hasLatentSteps() const noexcept;
+
+		/**
+		 * @brief Returns 'true' if any step of the plan branches or loops
+		*/
+		bool hasBranchSteps() const noexcept;
+
+		/**
+		 * @brief Executes a single step. Pure nodes are skipped in incremental mode
+		 * if none of the output ports they read from changed since their last execution.
+		*/
+		void execute(std::uint32_t stepIndex) const;
+
+		/**
+		 * @brief Executes all steps of the plan once for 'count' records. Folded steps are executed first.
+		 * Inputs are read from the column of their source port, or broadcast from its value if the column is empty.
+		 * Results are written to the columns of the output ports.
+		 * @return nothing or an Error if a step doesn't support batch execution or an input column is too short
+		*/
+		Expected<void, Error> runBatch(size_t count) const;
+
+		/**
+		 * @brief Enables skipping of pure nodes with unchanged inputs. Forces a full evaluation on the next run.
+		*/
+		void setIncremental(bool incremental);
+
+		inline bool incremental() const noexcept { return m_incremental; }
+
+		/**
+		 * @brief Records the duration of every executed step into 'profiler'. nullptr disables profiling.
+		 * The profiler must outlive the plan or be reset before it is destroyed.
+		*/
+		inline void setProfiler(Profiler* profiler) noexcept { m_profiler = profiler; }
+
+		inline bool empty() const noexcept { return m_steps.empty(); }
+
+		inline bool compiled() const noexcept { return m_compiled; }
+
+		inline const std::vector<ExecutionStep>& steps() const noexcept { return m_steps; }
+
+		/**
+		 * @brief Returns the steps removed by foldConstants(), in evaluation order. Their 'next' is meaningless.
+		*/
+		inline const std::vector<ExecutionStep>& foldedSteps() const noexcept { return m_foldedSteps; }
+
+		/**
+		 * @brief Returns the output port read by an input of a step. 'index' counts from ExecutionStep::firstInput.
+		 * @return nullptr if the input is not connected
+		*/
+		inline const OutputPortHandle* inputSource(std::uint32_t index) const noexcept { return m_inputSources[index]; }
+
+		/**
+		 * @brief Returns every distinct node scheduled by the plan
+		*/
+		const std::vector<Node*>& nodes() const noexcept { return m_nodes; }
+
+	private:
+		using NodeSet = std::unordered_set<const Node*>;
+		struct FlowCompilation;
+
+		/**
+		 * @brief Appends the steps of the flow starting at 'first'. The end of the flow continues at step 'exit'.
+		 * @return index of the first step of the flow
+		*/
+		Expected<std::int32_t, Error> compileFlow(FlowNode* first, std::int32_t exit, FlowCompilation& state);
+
+		Expected<void, Error> scheduleDependencies(Node& node, const NodeSet& chain, NodeSet& scheduled, std::vector<const Node*>& stack);
+
+		void appendStep(Node& node);
+
+		/**
+		 * @brief Removes all steps of 'nodes' from the plan. 'nodes' must be pure.
+		*/
+		void removeSteps(const NodeSet& nodes);
+
+		void bindInputs();
+
+		bool inputsChanged(std::uint32_t stepIndex) const;
+
+		void invoke(const ExecutionStep& step) const;
+
+		Expected<void, Error> executeBatch(const ExecutionStep& step, size_t count) const;
+
+		Expected<void, Error> resolveColumns(const ExecutionStep& step, size_t count) const;
+
+		bool isConstantVariable(const Node& node) const;
+
+		void evaluateFolded() const;
+
+	private:
+		std::vector<ExecutionStep> m_steps;
+		std::vector<void*> m_inputs;
+		std::vector<const OutputPortHandle*> m_inputSources;	// Ports behind m_inputs
+		std::vector<Node*> m_nodes;
+
+		// Constant folding. Folded steps are evaluated again once a variable in m_constantSources changed
+		std::vector<ExecutionStep> m_foldedSteps;
+		std::vector<const OutputPortHandle*> m_constantSources;
+		mutable std::vector<std::uint64_t> m_constantVersions;
+
+		// Evaluation state of the incremental mode
+		mutable std::vector<std::uint64_t> m_seenVersions;
+		mutable std::vector<std::uint8_t> m_evaluated;
+
+		// Inputs of the steps in batch mode. Resolved right before each step, as columns may be reallocated
+		mutable std::vector<ColumnView> m_columns;
+		Profiler* m_profiler = nullptr;
+		bool m_incremental = false;
+		bool m_compiled = false;
+	};
+}
@@ -0,0 +1,318 @@
+#include "script/FlowGraph.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace nf
+{
+
+	Expected<std::shared_ptr<const FlowGraph>, Error> FlowGraph::create(std::unique_ptr<FlowScript> script)
+	{
+		if (!script)
+			return make_unexpected(Error("FlowGraph requires a script", 135));
+
+		if (!script->build())
+			return make_unexpected(script->buildErrors().front());
+
+		std::shared_ptr<FlowGraph> graph(new FlowGraph(std::move(script)));
+		if (auto success = graph->compile(); !success)
+			return make_unexpected(success.error());
+
+		return std::shared_ptr<const FlowGraph>(std::move(graph));
+	}
+
+	FlowGraph::FlowGraph(std::unique_ptr<FlowScript> script)
+		: m_script(std::move(script))
+	{
+	}
+
+	FlowGraph::~FlowGraph() = default;
+
+	std::optional<FlowGraph::PortSlot> FlowGraph::findSlot(NodeHandle node, PortIndex index) const
+	{
+		const Node* foundNode = m_script->findNode(node);
+		if (!foundNode)
+			return std::nullopt;
+
+		const OutputPortHandle* port = foundNode->findOutputPort(index);
+		if (!port)
+			return std::nullopt;
+
+		auto it = m_slotIndex.find(port);
+		if (it == m_slotIndex.end())
+			return std::nullopt;
+
+		const Slot& slot = m_slots[it->second];
+		return PortSlot{ slot.offset, slot.typeID };
+	}
+
+	void FlowGraph::constructValues(std::byte* values) const
+	{
+		for (const Slot& slot : m_slots)
+			slot.ops->copyConstruct(values + slot.offset, slot.initial);
+	}
+
+	void FlowGraph::copyValues(std::byte* values, const std::byte* from) const
+	{
+		for (const Slot& slot : m_slots)
+			slot.ops->copyConstruct(values + slot.offset, from + slot.offset);
+	}
+
+	void FlowGraph::destroyValues(std::byte* values) const
+	{
+		for (const Slot& slot : m_slots)
+			slot.ops->destroy(values + slot.offset);
+	}
+
+	void FlowGraph::run(std::byte* values) const
+	{
+		const std::uint32_t* code = m_code.data();
+		std::uint32_t pc = 0;
+		for (;;)
+		{
+			switch (static_cast<Opcode>(code[pc]))
+			{
+			case Opcode::Call:
+			{
+				const Call& call = m_calls[code[pc + 1]];
+				call.thunk(call.node, values, code + pc + 3);
+				pc += 3 + code[pc + 2];
+				break;
+			}
+			case Opcode::JumpIfFalse:
+				pc = *reinterpret_cast<const bool*>(values + code[pc + 1]) ? pc + 3 : code[pc + 2];
+				break;
+
+			case Opcode::JumpIfTrue:
+				pc = *reinterpret_cast<const bool*>(values + code[pc + 1]) ? code[pc + 2] : pc + 3;
+				break;
+
+			case Opcode::ForLoop:
+			{
+				// Same as ForLoopNode::process(), with the loop state kept in the registers of the instance
+				const int first = *reinterpret_cast<const int*>(values + code[pc + 1]);
+				const int last = *reinterpret_cast<const int*>(values + code[pc + 2]);
+				int& index = *reinterpret_cast<int*>(values + code[pc + 3]);
+				bool& running = *reinterpret_cast<bool*>(values + code[pc + 4]);
+				if (!running)
+				{
+					index = first;
+					running = (first <= last);
+				}
+				else
+				{
+					running = (index < last);
+					if (running)
+						index++;
+				}
+				pc = running ? code[pc + 5] : pc + 6;
+				break;
+			}
+			case Opcode::Jump:
+				pc = code[pc + 1];
+				break;
+
+			case Opcode::Halt:
+				return;
+			}
+		}
+	}
+
+	Expected<std::vector<FlowGraph::Segment>, Error> FlowGraph::partition(size_t count) const
+	{
+		std::vector<std::uint32_t> calls;
+		for (std::uint32_t pc = 0; static_cast<Opcode>(m_code[pc]) != Opcode::Halt; pc += 3 + m_code[pc + 2])
+		{
+			if (static_cast<Opcode>(m_code[pc]) != Opcode::Call)
+				return make_unexpected(Error("Only graphs without branches and loops can be partitioned", 138));
+			calls.push_back(pc);
+		}
+
+		const auto haltAddress = static_cast<std::uint32_t>(m_code.size() - 1);
+		count = std::clamp<size_t>(count, 1, std::max<size_t>(calls.size(), 1));
+
+		std::vector<Segment> segments;
+		for (size_t i = 0; i < count; i++)
+		{
+			const size_t first = i * calls.size() / count;
+			const size_t last = (i + 1) * calls.size() / count;
+			segments.push_back(Segment{ (first < calls.size()) ? calls[first] : haltAddress, (last < calls.size()) ? calls[last] : haltAddress });
+		}
+		return segments;
+	}
+
+	void FlowGraph::run(std::byte* values, Segment segment) const
+	{
+		// Segments only contain calls, see partition()
+		const std::uint32_t* code = m_code.data();
+		for (std::uint32_t pc = segment.begin; pc < segment.end; pc += 3 + code[pc + 2])
+		{
+			const Call& call = m_calls[code[pc + 1]];
+			call.thunk(call.node, values, code + pc + 3);
+		}
+	}
+
+	Expected<void, Error> FlowGraph::compile()
+	{
+		const ExecutionPlan& plan = m_script->executionPlan();
+
+		// Folded steps run first for every instance, as an instance may assign the variables they read.
+		// They fall through into the first step of the plan.
+		for (const ExecutionStep& step : plan.foldedSteps())
+		{
+			if (auto success = emitStep(plan, step); !success)
+				return success;
+		}
+
+		const auto& steps = plan.steps();
+		for (std::uint32_t i = 0; i < steps.size(); i++)
+		{
+			m_stepAddress.push_back(static_cast<std::uint32_t>(m_code.size()));
+			if (auto success = emitStep(plan, steps[i]); !success)
+				return success;
+
+			const bool fallthrough = (steps[i].next == -1) ? (i + 1 == steps.size()) : (steps[i].next == static_cast<std::int32_t>(i + 1));
+			if (!fallthrough)
+				emitJump(steps[i].next);
+		}
+
+		const auto haltAddress = static_cast<std::uint32_t>(m_code.size());
+		m_code.push_back(static_cast<std::uint32_t>(Opcode::Halt));
+
+		for (const auto& [position, step] : m_targetOperands)
+			m_code[position] = (step == -1) ? haltAddress : m_stepAddress[step];
+		m_targetOperands.clear();
+		m_stepAddress.clear();
+
+		for (const Slot& slot : m_slots)
+		{
+			if (slot.ops == nullptr || slot.ops->copyConstruct == nullptr)
+				return make_unexpected(Error("Port values of a FlowGraph must be copy constructible", 135));
+		}
+
+		layoutSlots();
+		return {};
+	}
+
+	Expected<void, Error> FlowGraph::emitStep(const ExecutionPlan& plan, const ExecutionStep& step)
+	{
+		const Node& node = *step.node;
+		switch (node.getArchetype())
+		{
+		case NodeArchetype::Lang_IfElse:
+		case NodeArchetype::Lang_WhileLoop:
+		{
+			// IfElse jumps to 'False' if the condition fails, loops jump into their body while it holds
+			const bool ifElse = node.getArchetype() == NodeArchetype::Lang_IfElse;
+			m_code.push_back(static_cast<std::uint32_t>(ifElse ? Opcode::JumpIfFalse : Opcode::JumpIfTrue));
+			if (auto success = emitInput(plan, step, 0); !success)
+				return success;
+			emitTarget(step.jump);
+			return {};
+		}
+		case NodeArchetype::Lang_ForLoop:
+		{
+			static const bool notRunning = false;
+			m_code.push_back(static_cast<std::uint32_t>(Opcode::ForLoop));
+			for (std::uint32_t i = 0; i < step.inputCount; i++)
+			{
+				if (auto success = emitInput(plan, step, i); !success)
+					return success;
+			}
+			emitSlot(slotOf(node.getOutputPortList()[0]));
+			emitSlot(addSlot(detail::typeOpsOf<bool>(), &notRunning, type_id<bool>()));
+			emitTarget(step.jump);
+			return {};
+		}
+		default:
+			break;
+		}
+
+		const InstanceThunk thunk = node.instanceThunk();
+		if (thunk == nullptr)
+			return make_unexpected(Error(std::format("Node '{}' can't be shared between instances", node.nodeName()), 135));
+
+		m_code.push_back(static_cast<std::uint32_t>(Opcode::Call));
+		m_code.push_back(static_cast<std::uint32_t>(m_calls.size()));
+		m_code.push_back(static_cast<std::uint32_t>(step.inputCount + node.getOutputPortList().size()));
+		m_calls.push_back(Call{ &node, thunk });
+
+		for (std::uint32_t i = 0; i < step.inputCount; i++)
+		{
+			if (auto success = emitInput(plan, step, i); !success)
+				return success;
+		}
+
+		for (const OutputPortHandle& oPort : node.getOutputPortList())
+			emitSlot(slotOf(oPort));
+		return {};
+	}
+
+	void FlowGraph::emitJump(std::int32_t step)
+	{
+		m_code.push_back(static_cast<std::uint32_t>(Opcode::Jump));
+		emitTarget(step);
+	}
+
+	void FlowGraph::emitTarget(std::int32_t step)
+	{
+		m_targetOperands.emplace_back(m_code.size(), step);
+		m_code.push_back(0);
+	}
+
+	Expected<void, Error> FlowGraph::emitInput(const ExecutionPlan& plan, const ExecutionStep& step, std::uint32_t index)
+	{
+		const OutputPortHandle* source = plan.inputSource(step.firstInput + index);
+		if (source == nullptr)
+			return make_unexpected(Error(std::format("Node '{}' has an unconnected input", step.node->nodeName()), 135));
+
+		emitSlot(slotOf(*source));
+		return {};
+	}
+
+	void FlowGraph::emitSlot(std::uint32_t slot)
+	{
+		m_registerOperands.push_back(m_code.size());
+		m_code.push_back(slot);
+	}
+
+	std::uint32_t FlowGraph::slotOf(const OutputPortHandle& port)
+	{
+		auto [it, inserted] = m_slotIndex.try_emplace(&port, static_cast<std::uint32_t>(m_slots.size()));
+		if (inserted)
+			m_slots.push_back(Slot{ 0, port.typeOps(), port.dataHandle().data(), port.dataHandle().typeID() });
+		return it->second;
+	}
+
+	std::uint32_t FlowGraph::addSlot(const detail::TypeOps& ops, const void* initial, typeid_t typeID)
+	{
+		m_slots.push_back(Slot{ 0, &ops, initial, typeID });
+		return static_cast<std::uint32_t>(m_slots.size() - 1);
+	}
+
+	void FlowGraph::layoutSlots()
+	{
+		// Place strictly aligned values first, which avoids most of the padding
+		std::vector<std::uint32_t> order(m_slots.size());
+		std::iota(order.begin(), order.end(), 0u);
+		std::stable_sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) {
+			return m_slots[a].ops->alignment > m_slots[b].ops->alignment;
+		});
+
+		size_t offset = 0;
+		for (std::uint32_t index : order)
+		{
+			Slot& slot = m_slots[index];
+			const size_t alignment = slot.ops->alignment;
+			offset = (offset + alignment - 1) / alignment * alignment;
+			slot.offset = static_cast<std::uint32_t>(offset);
+			offset += slot.ops->size;
+			m_blockAlignment = std::max(m_blockAlignment, alignment);
+		}
+		m_blockSize = offset;
+
+		for (size_t position : m_registerOperands)
+			m_code[position] = m_slots[m_code[position]].offset;
+		m_registerOperands.clear();
+	}
+}
@@ -0,0 +1,201 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+#include <vector>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+#include "typedefs.hpp"
+#include "core/Error.hpp"
+#include "utility/Expected.hpp"
+#include "script/FlowScript.hpp"
+
+namespace nf
+{
+	/**
+	 * @brief Immutable, shareable form of a FlowScript: topology, port metadata and compiled execution order.
+	 * The values of all ports used during execution are packed into a single block of memory, which is owned
+	 * by each FlowInstance. Thousands of instances can so share one graph and only pay for their own values.
+	 * The execution order is compiled into a contiguous bytecode buffer operating on that block as register file.
+	 * Every executed node must be stateless (see Node::instanceThunk()), which currently holds for FunctorNodes
+	 * and ConversionNodes. IfElse and loop nodes are compiled into jumps, loop state is kept in the register file.
+	*/
+	class FlowGraph
+	{
+	public:
+		/**
+		 * @brief Location of a port value within the value block of an instance
+		*/
+		struct PortSlot
+		{
+			std::uint32_t offset = 0;
+			typeid_t typeID = 0;
+		};
+
+		/**
+		 * @brief Contiguous range of the bytecode, ex. the part a single stage of a FlowPipeline executes
+		*/
+		struct Segment
+		{
+			std::uint32_t begin = 0;
+			std::uint32_t end = 0;
+		};
+
+	public:
+		/**
+		 * @brief Builds 'script' and takes ownership of it. The script can't be modified afterwards.
+		 * Values of its ports at this point become the initial values of every instance.
+		 * @return the graph or an Error if the build failed or a node can't be shared between instances
+		*/
+		static Expected<std::shared_ptr<const FlowGraph>, Error> create(std::unique_ptr<FlowScript> script);
+
+		~FlowGraph();
+
+		FlowGraph(const FlowGraph&) = delete;
+		FlowGraph& operator=(const FlowGraph&) = delete;
+
+		const FlowScript& script() const noexcept { return *m_script; }
+
+		/**
+		 * @brief Returns the location of an output port's value within an instance
+		 * @return std::nullopt if the port is not used by the graph
+		*/
+		std::optional<PortSlot> findSlot(NodeHandle node, PortIndex index) const;
+
+		inline size_t valueBlockSize() const noexcept { return m_blockSize; }
+
+		inline size_t valueBlockAlignment() const noexcept { return m_blockAlignment; }
+
+		/**
+		 * @brief Copy-constructs the initial values into an uninitialized block
+		*/
+		void constructValues(std::byte* values) const;
+
+		void copyValues(std::byte* values, const std::byte* from) const;
+
+		void destroyValues(std::byte* values) const;
+
+		/**
+		 * @brief Executes the graph on the values of one instance. Different blocks may be run concurrently.
+		*/
+		void run(std::byte* values) const;
+
+		/**
+		 * @brief Splits the graph into up to 'count' segments with a similar number of node calls, in execution order.
+		 * Running all segments in order equals run().
+		 * @return the segments or an Error if the graph branches or loops, as a segment must run straight through
+		*/
+		Expected<std::vector<Segment>, Error> partition(size_t count) const;
+
+		/**
+		 * @brief Executes a single segment returned by partition() on the values of one instance
+		*/
+		void run(std::byte* values, Segment segment) const;
+
+	private:
+		explicit FlowGraph(std::unique_ptr<FlowScript> script);
+
+		Expected<void, Error> compile();
+
+		Expected<void, Error> emitStep(const ExecutionPlan& plan, const ExecutionStep& step);
+
+		void emitJump(std::int32_t step);
+
+		/**
+		 * @brief Emits the address of a plan step, resolved once all steps are emitted. -1 halts.
+		*/
+		void emitTarget(std::int32_t step);
+
+		/**
+		 * @brief Emits the register of input 'index' of a step
+		*/
+		Expected<void, Error> emitInput(const ExecutionPlan& plan, const ExecutionStep& step, std::uint32_t index);
+
+		void emitSlot(std::uint32_t slot);
+
+		std::uint32_t slotOf(const OutputPortHandle& port);
+
+		/**
+		 * @brief Adds a register that is not backed by a port, ex. the state of a loop
+		*/
+		std::uint32_t addSlot(const detail::TypeOps& ops, const void* initial, typeid_t typeID);
+
+		void layoutSlots();
+
+	private:
+		struct Slot
+		{
+			std::uint32_t offset = 0;
+			const detail::TypeOps* ops = nullptr;
+			const void* initial = nullptr;	// Value of the port within the script
+			typeid_t typeID = 0;
+		};
+
+		/**
+		 * @brief Instructions of the bytecode. Their operands follow within the same buffer.
+		 * Registers are byte offsets into the value block, targets are indices into the bytecode.
+		*/
+		enum class Opcode : std::uint32_t
+		{
+			Call,			// call index, register count, registers of the inputs followed by the outputs
+			JumpIfFalse,	// condition register, target
+			JumpIfTrue,		// condition register, target
+			ForLoop,		// first, last, index and running registers, target of the body
+			Jump,			// target
+			Halt
+		};
+
+		struct Call
+		{
+			const Node* node = nullptr;
+			InstanceThunk thunk = nullptr;
+		};
+
+		std::unique_ptr<FlowScript> m_script;
+		std::vector<Slot> m_slots;
+		std::vector<std::uint32_t> m_code;
+		std::vector<Call> m_calls;
+		std::vector<size_t> m_registerOperands;	// Positions in m_code holding slot indices until layoutSlots()
+		std::vector<std::pair<size_t, std::int32_t>> m_targetOperands; // Positions in m_code holding a step index until compile() finished
+		std::vector<std::uint32_t> m_stepAddress;	// Plan step -> its first instruction
+		std::unordered_map<const OutputPortHandle*, std::uint32_t> m_slotIndex;
+		size_t m_blockSize = 0;
+		size_t m_blockAlignment = 1;
+	};
+}
@@ -0,0 +1,81 @@
+#include "script/FlowInstance.hpp"
+
+#include <new>
+#include <algorithm>
+
+namespace nf
+{
+
+	FlowInstance::FlowInstance(std::shared_ptr<const FlowGraph> graph)
+		: m_graph(std::move(graph))
+	{
+		NF_ASSERT(m_graph, "FlowInstance requires a graph");
+		m_values = allocateValues();
+		m_graph->constructValues(m_values);
+	}
+
+	FlowInstance::FlowInstance(const FlowInstance& other)
+		: m_graph(other.m_graph)
+	{
+		m_values = allocateValues();
+		m_graph->copyValues(m_values, other.m_values);
+	}
+
+	FlowInstance::FlowInstance(FlowInstance&& other) noexcept
+		: m_graph(std::move(other.m_graph)), m_values(std::exchange(other.m_values, nullptr))
+	{
+	}
+
+	FlowInstance& FlowInstance::operator=(const FlowInstance& other)
+	{
+		if (this != &other)
+		{
+			FlowInstance copy(other);
+			*this = std::move(copy);
+		}
+		return *this;
+	}
+
+	FlowInstance& FlowInstance::operator=(FlowInstance&& other) noexcept
+	{
+		if (this != &other)
+		{
+			releaseValues();
+			m_graph = std::move(other.m_graph);
+			m_values = std::exchange(other.m_values, nullptr);
+		}
+		return *this;
+	}
+
+	FlowInstance::~FlowInstance()
+	{
+		releaseValues();
+	}
+
+	void FlowInstance::run()
+	{
+		m_graph->run(m_values);
+	}
+
+	void FlowInstance::run(FlowGraph::Segment segment)
+	{
+		m_graph->run(m_values, segment);
+	}
+
+	std::byte* FlowInstance::allocateValues() const
+	{
+		// Never empty, so a moved-from instance can be told apart
+		const size_t size = std::max<size_t>(m_graph->valueBlockSize(), 1);
+		return static_cast<std::byte*>(::operator new(size, std::align_val_t(m_graph->valueBlockAlignment())));
+	}
+
+	void FlowInstance::releaseValues()
+	{
+		if (!m_values)
+			return;
+
+		m_graph->destroyValues(m_values);
+		::operator delete(m_values, std::align_val_t(m_graph->valueBlockAlignment()));
+		m_values = nullptr;
+	}
+}
@@ -0,0 +1,126 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+#include <memory>
+#include <utility>
+#include <cstddef>
+
+#include "typedefs.hpp"
+#include "script/FlowGraph.hpp"
+
+namespace nf
+{
+	/**
+	 * @brief Lightweight execution state of a shared FlowGraph. Holds only a packed block of port values.
+	 * Instances of the same graph may be run concurrently from different threads.
+	*/
+	class FlowInstance
+	{
+	public:
+		explicit FlowInstance(std::shared_ptr<const FlowGraph> graph);
+
+		FlowInstance(const FlowInstance& other);
+		FlowInstance(FlowInstance&& other) noexcept;
+
+		FlowInstance& operator=(const FlowInstance& other);
+		FlowInstance& operator=(FlowInstance&& other) noexcept;
+
+		~FlowInstance();
+
+		/**
+		 * @brief Executes the graph once on the values of this instance
+		*/
+		void run();
+
+		/**
+		 * @brief Executes a single segment of the graph (see FlowGraph::partition())
+		*/
+		void run(FlowGraph::Segment segment);
+
+		/**
+		 * @brief Returns the value of a port. Resolve the slot once via FlowGraph::findSlot()
+		 * @return nullptr if 'T' is not the type of the port
+		*/
+		template<typename T>
+		const T* value(FlowGraph::PortSlot slot) const
+		{
+			if (slot.typeID != type_id<T>())
+				return nullptr;
+			return reinterpret_cast<const T*>(m_values + slot.offset);
+		}
+
+		template<typename T>
+		T* valueMutable(FlowGraph::PortSlot slot)
+		{
+			if (slot.typeID != type_id<T>())
+				return nullptr;
+			return reinterpret_cast<T*>(m_values + slot.offset);
+		}
+
+		template<typename T>
+		const T* value(NodeHandle node, PortIndex index) const
+		{
+			auto slot = m_graph->findSlot(node, index);
+			return slot ? value<T>(*slot) : nullptr;
+		}
+
+		/**
+		 * @brief Assigns the value of a port, typically the one of a DataNode feeding the graph
+		 * @return 'false' if the port is not used by the graph or 'T' is not its type
+		*/
+		template<typename T>
+		bool setValue(NodeHandle node, PortIndex index, T value)
+		{
+			auto slot = m_graph->findSlot(node, index);
+			T* target = slot ? valueMutable<T>(*slot) : nullptr;
+			if (!target)
+				return false;
+
+			*target = std::move(value);
+			return true;
+		}
+
+		inline const std::shared_ptr<const FlowGraph>& graph() const noexcept { return m_graph; }
+
+	private:
+		std::byte* allocateValues() const;
+
+		void releaseValues();
+
+	private:
+		std::shared_ptr<const FlowGraph> m_graph;
+		std::byte* m_values = nullptr;
+	};
+}
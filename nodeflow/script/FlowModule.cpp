@@ -37,6 +37,17 @@ namespace nf
 		return m_flowNodeCreators;
 	}
 
+	Expected<void, RegisterError> FlowModule::registerLanguageNodes()
+	{
+		if (auto success = registerCustomNode<IfElseNode>(lang::IfElse); !success)
+			return success;
+
+		if (auto success = registerCustomNode<WhileLoopNode>(lang::While); !success)
+			return success;
+
+		return registerCustomNode<ForLoopNode>(lang::For);
+	}
+
 	const nf::FlowModule::DataNodeCreatorMap& FlowModule::dataCreators() const
 	{
 		return m_dataNodeCreators;
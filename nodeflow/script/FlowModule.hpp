@@ -51,6 +51,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "nodes/FunctorNode.hpp"
 #include "nodes/EventNode.hpp"
 #include "nodes/ConversionNode.hpp"
+#include "nodes/IfElseNode.hpp"
+#include "nodes/LoopNodes.hpp"
 
 #include "../3rdparty/cpputils/prettyprint.h"
 using namespace cpputils;
@@ -101,8 +103,9 @@ namespace nf {
 	class FlowModule
 	{
 	public:
-		using FlowNodeCreator = std::function<std::unique_ptr<nf::FlowNode>()>;
-		using DataNodeCreator = std::function<std::unique_ptr<VariableNode>()>;
+		// Creators allocate the node from the given resource (see makeNode())
+		using FlowNodeCreator = std::function<NodePtr<nf::FlowNode>(std::pmr::memory_resource&)>;
+		using DataNodeCreator = std::function<NodePtr<VariableNode>(std::pmr::memory_resource&)>;
 
 		using FlowNodeCreatorMap = std::map<std::string, FlowNodeCreator>;
 		using DataNodeCreatorMap = std::map<std::string, DataNodeCreator>;
@@ -119,8 +122,31 @@ namespace nf {
 		template<class Node>
 		Expected<void, RegisterError> registerCustomNode(const std::string& namePath);
 
+		/**
+		 * @brief Registers a free function or captureless lambda as FunctorNode.
+		 * @param purity Purity::Pure and Purity::PureUncached declare that the result depends solely on the arguments,
+		 * so the node may be skipped if its inputs didn't change. Results of Purity::Pure functions are also cached
+		 * in FunctorNode<func>::resultCache() (see Purity).
+		*/
 		template<auto func>
-		Expected<void, RegisterError> registerFunction(const std::string& namePath, const FunctorPortNames& portNames = {});
+		Expected<void, RegisterError> registerFunction(const std::string& namePath, const FunctorPortNames& portNames = {}, 
+													   Purity purity = Purity::Impure);
+
+		/**
+		 * @brief Registers a function together with a kernel processing whole columns in batch mode.
+		 * The kernel takes (std::span<Result> out, std::span<const Args>... in) and must produce the same results as 'func'.
+		*/
+		template<auto func, auto batchKernel>
+		Expected<void, RegisterError> registerFunction(const std::string& namePath, const FunctorPortNames& portNames = {},
+													   Purity purity = Purity::Impure);
+
+		/**
+		 * @brief Declares the C++ name of a registered function, so scripts calling it can be exported as native code.
+		 * @param nativeName fully qualified name addressing exactly one function, ex. "nf::add<float>"
+		 * @param header header declaring the function, included by the generated code
+		*/
+		template<auto func>
+		void nativizeFunction(const std::string& nativeName, const std::string& header);
 
 		template<class ClassNode>
 		Expected<void, Error> registerClass(const std::string& category);
@@ -131,6 +157,11 @@ namespace nf {
 		template<class Node>
 		Expected<void, Error> registerStartEventNode(const std::string& namePath);
 
+		/**
+		 * @brief Registers the branch and loop nodes under the names in nf::lang
+		*/
+		Expected<void, RegisterError> registerLanguageNodes();
+
 
 		void setModuleName(const std::string& name);
 
@@ -171,9 +202,9 @@ namespace nf {
 
 		if (!categoryName.empty()) m_categoryNames.insert(categoryName);
 
-		DataNodeImpl<T>::staticNodeName = baseName;
-		auto makerLambda = []() {
-			std::unique_ptr<nf::DataNode> uptr = std::make_unique<DataNodeImpl<T>>();
+		DataNodeImpl<T>::staticNodeName = InternedName(baseName);
+		auto makerLambda = [](std::pmr::memory_resource& resource) {
+			NodePtr<nf::DataNode> uptr = makeNode<DataNodeImpl<T>>(resource);
 			uptr->assignTypeID(type_id<DataNodeImpl<T>>());
 			return uptr;
 		};
@@ -195,8 +226,8 @@ namespace nf {
 
 		if (!categoryName.empty()) m_categoryNames.insert(categoryName);
 
-		auto makerLambda = []() {
-			std::unique_ptr<nf::FlowNode> uptr = std::make_unique<Node>();
+		auto makerLambda = [](std::pmr::memory_resource& resource) {
+			NodePtr<nf::FlowNode> uptr = makeNode<Node>(resource);
 			uptr->assignTypeID(type_id<Node>());
 			return uptr;
 		};
@@ -206,7 +237,8 @@ namespace nf {
 	}
 
 	template<auto func>
-	Expected<void, RegisterError> FlowModule::registerFunction(const std::string& namePath, const FunctorPortNames& portNames/* = {}*/)
+	Expected<void, RegisterError> FlowModule::registerFunction(const std::string& namePath, const FunctorPortNames& portNames/* = {}*/, 
+															   Purity purity /*= Purity::Impure*/)
 	{
 		static_assert(!std::is_member_function_pointer<decltype(func)>::value, "Callable must be lambda or free function");
 
@@ -218,12 +250,18 @@ namespace nf {
 
 		if (!categoryName.empty()) m_categoryNames.insert(categoryName);
 
-		FunctorNode<func>::staticNodeName = baseName;
-		FunctorNode<func>::staticResultPortName = portNames.outputName;
-		if (!portNames.inputNames.empty()) FunctorNode<func>::staticArgPortNames = portNames.inputNames;
-
-		auto makerLambda = []() {
-			std::unique_ptr<nf::FlowNode> uptr = std::make_unique<FunctorNode<func>>();
+		FunctorNode<func>::staticNodeName = InternedName(baseName);
+		FunctorNode<func>::staticResultPortName = InternedName(portNames.outputName);
+		if (!portNames.inputNames.empty())
+		{
+			FunctorNode<func>::staticArgPortNames.clear();
+			for (const auto& name : portNames.inputNames)
+				FunctorNode<func>::staticArgPortNames.emplace_back(name);
+		}
+		FunctorNode<func>::staticPurity = purity;
+
+		auto makerLambda = [](std::pmr::memory_resource& resource) {
+			NodePtr<nf::FlowNode> uptr = makeNode<FunctorNode<func>>(resource);
 			uptr->assignTypeID(type_id<FunctorNode<func>>());
 			return uptr;
 		};
@@ -232,6 +270,28 @@ namespace nf {
 
 		return {};
 	}
+
+	template<auto func, auto batchKernel>
+	Expected<void, RegisterError> FlowModule::registerFunction(const std::string& namePath, const FunctorPortNames& portNames/* = {}*/,
+															   Purity purity /*= Purity::Impure*/)
+	{
+		using BatchKernel_t = typename FunctorNode<func>::BatchKernel_t;
+		static_assert(std::is_convertible_v<decltype(batchKernel), BatchKernel_t>, "Kernel signature must match the columns of the function");
+
+		auto success = registerFunction<func>(namePath, portNames, purity);
+		if (!success)
+			return success;
+
+		FunctorNode<func>::staticBatchKernel = static_cast<BatchKernel_t>(batchKernel);
+		return {};
+	}
+
+	template<auto func>
+	void FlowModule::nativizeFunction(const std::string& nativeName, const std::string& header)
+	{
+		FunctorNode<func>::staticNativeSymbol = NativeSymbol{ nativeName, header };
+	}
+
 	template<class ClassNode>
 	Expected<void, Error> FlowModule::registerClass(const std::string& category)
 	{
@@ -256,12 +316,12 @@ namespace nf {
 		static_assert(std::tuple_size_v<From_ts> == 1, "Callable must be of signature: 'ToType Callable(FromType)'");
 		using From_t = std::tuple_element_t<0, From_ts>; // top-most const already removed;
 
-		ConversionNodeImpl<From_t, To_t, Callable>::staticNodeName = baseName;
-		ConversionNodeImpl<From_t, To_t, Callable>::staticInputPortName = portName.inputName;
-		ConversionNodeImpl<From_t, To_t, Callable>::staticOutputPortName = portName.outputName;
+		ConversionNodeImpl<From_t, To_t, Callable>::staticNodeName = InternedName(baseName);
+		ConversionNodeImpl<From_t, To_t, Callable>::staticInputPortName = InternedName(portName.inputName);
+		ConversionNodeImpl<From_t, To_t, Callable>::staticOutputPortName = InternedName(portName.outputName);
 
-		auto makerLambda = []() {
-			std::unique_ptr<nf::FlowNode> uptr = std::make_unique<ConversionNodeImpl<From_t, To_t, Callable>>();
+		auto makerLambda = [](std::pmr::memory_resource& resource) {
+			NodePtr<nf::FlowNode> uptr = makeNode<ConversionNodeImpl<From_t, To_t, Callable>>(resource);
 			uptr->assignTypeID(type_id<ConversionNodeImpl<From_t, To_t, Callable>>());
 			return uptr;
 		};
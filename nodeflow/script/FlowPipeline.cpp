@@ -0,0 +1,84 @@
+#include "script/FlowPipeline.hpp"
+
+namespace nf
+{
+	Expected<std::unique_ptr<FlowPipeline>, Error> FlowPipeline::create(std::shared_ptr<const FlowGraph> graph, size_t stageCount,
+		size_t queueCapacity /*= 64*/, BackpressurePolicy policy /*= BackpressurePolicy::Block*/)
+	{
+		if (!graph)
+			return make_unexpected(Error("FlowPipeline requires a graph", 138));
+
+		auto segments = graph->partition(stageCount);
+		if (!segments)
+			return make_unexpected(segments.error());
+
+		return std::unique_ptr<FlowPipeline>(new FlowPipeline(std::move(graph), std::move(segments.value()), queueCapacity, policy));
+	}
+
+	FlowPipeline::FlowPipeline(std::shared_ptr<const FlowGraph> graph, std::vector<FlowGraph::Segment> segments,
+		size_t queueCapacity, BackpressurePolicy policy)
+		: m_graph(std::move(graph)), m_segments(std::move(segments)), m_policy(policy)
+	{
+		for (size_t i = 0; i <= m_segments.size(); i++)
+			m_queues.push_back(std::make_unique<SpscQueue<FlowInstance>>(queueCapacity));
+
+		for (size_t i = 0; i < m_segments.size(); i++)
+			m_threads.emplace_back(&FlowPipeline::stageLoop, this, i);
+	}
+
+	FlowPipeline::~FlowPipeline()
+	{
+		m_stop.store(true);
+		for (auto& queue : m_queues)
+			queue->wakeAll();
+		for (auto& thread : m_threads)
+			thread.join();
+	}
+
+	bool FlowPipeline::push(FlowInstance record)
+	{
+		if (record.graph() != m_graph)
+			return false;
+
+		SpscQueue<FlowInstance>& input = *m_queues.front();
+		while (!input.tryPush(std::move(record)))
+		{
+			if (m_policy == BackpressurePolicy::DropNewest)
+			{
+				m_dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			if (!input.waitUntilWritable(m_stop))
+				return false;
+		}
+		return true;
+	}
+
+	std::optional<FlowInstance> FlowPipeline::tryPop()
+	{
+		return m_queues.back()->tryPop();
+	}
+
+	void FlowPipeline::stageLoop(size_t stage)
+	{
+		SpscQueue<FlowInstance>& input = *m_queues[stage];
+		SpscQueue<FlowInstance>& output = *m_queues[stage + 1];
+		const FlowGraph::Segment segment = m_segments[stage];
+
+		while (input.waitUntilReadable(m_stop))
+		{
+			auto record = input.tryPop();
+			if (!record)
+				continue;
+
+			record->run(segment);
+
+			// The next stage blocks this one, dropping here would discard work already done
+			while (!output.tryPush(std::move(*record)))
+			{
+				if (!output.waitUntilWritable(m_stop))
+					return;
+			}
+		}
+	}
+}
@@ -0,0 +1,121 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+#include <vector>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <atomic>
+#include <cstddef>
+
+#include "typedefs.hpp"
+#include "core/Error.hpp"
+#include "utility/Expected.hpp"
+#include "utility/SpscQueue.hpp"
+#include "script/FlowGraph.hpp"
+#include "script/FlowInstance.hpp"
+
+namespace nf
+{
+	/**
+	 * @brief Behavior of FlowPipeline::push() while the first stage can't accept another record
+	*/
+	enum class BackpressurePolicy
+	{
+		Block,		// Wait until the first stage accepted the record
+		DropNewest	// Discard the record
+	};
+
+	/**
+	 * @brief Streams records through a FlowGraph that is partitioned into stages, each running on its own thread.
+	 * A record is a FlowInstance, so its port values travel through the pipeline as a whole. Stages are connected
+	 * by bounded SpscQueues: record k+1 is processed by the first stage while record k is processed by the second.
+	 * Records leave the pipeline in the order they were pushed. Stages only block on each other, records are
+	 * never dropped once they entered the pipeline.
+	 * push() and tryPop() may be called from different threads, but each one only from a single thread.
+	*/
+	class FlowPipeline
+	{
+	public:
+		/**
+		 * @param stageCount number of stages and threads. Limited to the number of nodes of the graph
+		 * @param queueCapacity number of records each queue between two stages holds
+		 * @return the running pipeline or an Error if the graph branches or loops (see FlowGraph::partition())
+		*/
+		static Expected<std::unique_ptr<FlowPipeline>, Error> create(std::shared_ptr<const FlowGraph> graph, size_t stageCount,
+			size_t queueCapacity = 64, BackpressurePolicy policy = BackpressurePolicy::Block);
+
+		/**
+		 * @brief Stops all stages. Records still within the pipeline are discarded.
+		*/
+		~FlowPipeline();
+
+		FlowPipeline(const FlowPipeline&) = delete;
+		FlowPipeline& operator=(const FlowPipeline&) = delete;
+
+		/**
+		 * @brief Feeds a record into the first stage, typically with its inputs assigned via FlowInstance::setValue().
+		 * @return 'false' if the record was dropped or belongs to a different graph
+		*/
+		bool push(FlowInstance record);
+
+		/**
+		 * @brief Takes the next record that passed all stages
+		 * @return std::nullopt if no record completed yet
+		*/
+		std::optional<FlowInstance> tryPop();
+
+		inline size_t stageCount() const noexcept { return m_segments.size(); }
+
+		/**
+		 * @brief Returns the number of records discarded by BackpressurePolicy::DropNewest
+		*/
+		inline size_t dropped() const noexcept { return m_dropped.load(std::memory_order_relaxed); }
+
+	private:
+		FlowPipeline(std::shared_ptr<const FlowGraph> graph, std::vector<FlowGraph::Segment> segments,
+			size_t queueCapacity, BackpressurePolicy policy);
+
+		void stageLoop(size_t stage);
+
+	private:
+		std::shared_ptr<const FlowGraph> m_graph;
+		std::vector<FlowGraph::Segment> m_segments;
+		std::vector<std::unique_ptr<SpscQueue<FlowInstance>>> m_queues;	// Queue 'i' feeds stage 'i', the last one holds completed records
+		std::vector<std::thread> m_threads;
+		BackpressurePolicy m_policy;
+		std::atomic<size_t> m_dropped{ 0 };
+		std::atomic<bool> m_stop{ false };
+	};
+}
@@ -3,28 +3,288 @@
 namespace nf
 {
 
-	nf::Node* FlowScript::findNode(NodeHandle uuid) const
+	FlowScript::FlowScript(std::shared_ptr<FlowModule> scriptModule)
+		: m_scriptModule(std::move(scriptModule))
 	{
-		// FIXME: A data structure like unordered_map would definitely make more sense here.
-		//        But I'm not sure yet how to execute the nodes later. Vectors might be more performant then.
+		auto startNode = makeNode<StartEventNode>(m_nodePool);
+		startNode->setPortTable(m_portTable);
+		auto setupSuccess = startNode->setup();
+		NF_ASSERT(setupSuccess, "StartEventNode setup failed");
+		NF_UNUSED(setupSuccess);
+
+		m_startNode = startNode.get();
+		insertNode(*startNode, { 0, m_callablesNodes.size() });
+		m_callablesNodes.push_back(std::move(startNode));
+	}
+
+	FlowScript::~FlowScript()
+	{
+		// Nodes must outlive the plan that is bound to them
+		invalidateExecutionPlan();
+
+		// The port table is released as a whole, so nodes don't need to give their rows back one by one
 		for (auto& node : m_callablesNodes)
+			node->m_portTable = nullptr;
+		for (auto& node : m_variableNodes)
+			node->m_portTable = nullptr;
+	}
+
+	Expected<void, Error> FlowScript::precomputeExecutionOrder()
+	{
+		return m_executionPlan.compile(*m_startNode);
+	}
+
+	StartEventNode& FlowScript::startEventNode() const
+	{
+		return *m_startNode;
+	}
+
+	bool FlowScript::build()
+	{
+		m_buildErrors.clear();
+		m_nativeExecutor.reset();
+
+		if (auto success = precomputeExecutionOrder(); !success)
 		{
-			if (node->uuid() == uuid)
-				return node.get();
+			m_buildErrors.push_back(success.error());
+			return false;
 		}
 
-		for (auto& node : m_variableNodes)
+		if (m_deadNodeElimination)
+			m_executionPlan.eliminateDeadNodes(m_observedOutputs);
+
+		m_prunedNodes.clear();
+		const std::unordered_set<const Node*> scheduled(m_executionPlan.nodes().begin(), m_executionPlan.nodes().end());
+		for (const auto& node : m_callablesNodes)
 		{
-			if (node->uuid() == uuid)
-				return node.get();
+			if (node.get() != m_startNode && !scheduled.contains(node.get()))
+				m_prunedNodes.push_back(node->handle());
 		}
 
-		return nullptr;
+		for (Node* node : m_executionPlan.nodes())
+		{
+			if (auto success = node->onBuild(); !success)
+				m_buildErrors.push_back(success.error());
+		}
+
+		if (m_executionPlan.hasBranchSteps() && m_executionPolicy == ExecutionPolicy::Parallel)
+			m_buildErrors.push_back(Error("Branch and loop nodes require ExecutionPolicy::Sequential", 136));
+
+		if (m_executionPlan.hasLatentSteps())
+		{
+			if (m_executionPolicy == ExecutionPolicy::Parallel)
+				m_buildErrors.push_back(Error("Latent nodes require ExecutionPolicy::Sequential", 134));
+
+			for (const auto& step : m_executionPlan.steps())
+			{
+				if (step.latent)
+					static_cast<LatentFlowNode*>(step.node)->m_latentQueue = &m_latentQueue;
+			}
+		}
+
+		if (!m_buildErrors.empty())
+		{
+			m_executionPlan.clear();
+			return false;
+		}
+
+		m_executionPlan.foldConstants();
+
+		if (m_executionPolicy == ExecutionPolicy::Parallel)
+			m_parallelScheduler.compile(m_executionPlan);
+
+		return true;
 	}
 
-	bool FlowScript::hasNode(NodeHandle uuid) const
+	void FlowScript::run()
 	{
-		return findNode(uuid) != nullptr;
+		if (m_suspendedStep != -1)
+			return;
+
+		if (!m_executionPlan.compiled() && !build())
+			return;
+
+		m_executionPlan.refreshConstants();
+
+		if (m_nativeExecutor)
+			m_nativeExecutor->run();
+		else if (m_executionPolicy == ExecutionPolicy::Parallel)
+			m_parallelScheduler.run(*m_threadPool);
+		else
+			m_suspendedStep = m_executionPlan.run();
+	}
+
+	size_t FlowScript::update()
+	{
+		const size_t resumed = m_latentQueue.update();
+		if (m_suspendedStep == -1)
+			return resumed;
+
+		const ExecutionStep& step = m_executionPlan.steps()[m_suspendedStep];
+		auto latentNode = static_cast<LatentFlowNode*>(step.node);
+		if (latentNode->suspended())
+			return resumed;
+
+		m_suspendedStep = -1;
+		latentNode->completeLatent();
+
+		if (step.next != -1)
+			m_suspendedStep = m_executionPlan.run(step.next);
+		return resumed;
+	}
+
+	bool FlowScript::suspended() const noexcept
+	{
+		return m_suspendedStep != -1;
+	}
+
+	void FlowScript::setAsyncPool(std::shared_ptr<ThreadPool> pool)
+	{
+		m_latentQueue.setAsyncPool(std::move(pool));
+	}
+
+	Expected<void, Error> FlowScript::runBatch(size_t count)
+	{
+		if (!m_executionPlan.compiled() && !build())
+			return make_unexpected(m_buildErrors.front());
+
+		return m_executionPlan.runBatch(count);
+	}
+
+	void FlowScript::setExecutionPolicy(ExecutionPolicy policy, size_t workerCount /*= 0*/)
+	{
+		invalidateExecutionPlan();
+		m_executionPolicy = policy;
+
+		if (policy == ExecutionPolicy::Sequential)
+		{
+			m_threadPool.reset();
+			return;
+		}
+
+		if (workerCount == 0)
+			workerCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+		if (!m_threadPool || m_threadPool->workerCount() != workerCount)
+			m_threadPool = std::make_unique<ThreadPool>(workerCount);
+	}
+
+	ExecutionPolicy FlowScript::executionPolicy() const noexcept
+	{
+		return m_executionPolicy;
+	}
+
+	void FlowScript::setIncrementalEvaluation(bool enabled)
+	{
+		m_executionPlan.setIncremental(enabled);
+	}
+
+	bool FlowScript::incrementalEvaluation() const noexcept
+	{
+		return m_executionPlan.incremental();
+	}
+
+	void FlowScript::setDeadNodeElimination(bool enabled)
+	{
+		invalidateExecutionPlan();
+		m_deadNodeElimination = enabled;
+	}
+
+	bool FlowScript::deadNodeElimination() const noexcept
+	{
+		return m_deadNodeElimination;
+	}
+
+	bool FlowScript::observeOutput(NodeHandle node, PortIndex index)
+	{
+		auto foundNode = findNode(node);
+		if (!foundNode)
+			return false;
+
+		auto port = foundNode->findOutputPort(index);
+		if (!port)
+			return false;
+
+		if (m_observedOutputs.insert(port).second && m_deadNodeElimination)
+			invalidateExecutionPlan();
+		return true;
+	}
+
+	const std::vector<NodeHandle>& FlowScript::prunedNodes() const noexcept
+	{
+		return m_prunedNodes;
+	}
+
+	const std::vector<Error>& FlowScript::buildErrors() const noexcept
+	{
+		return m_buildErrors;
+	}
+
+	Expected<std::string, Error> FlowScript::exportNative()
+	{
+		if (!m_executionPlan.compiled() && !build())
+			return make_unexpected(m_buildErrors.front());
+
+		auto source = NativeCodegen::generate(m_executionPlan);
+		if (!source)
+			return make_unexpected(source.error());
+		return std::move(source->code);
+	}
+
+	Expected<void, Error> FlowScript::loadNative(const std::string& libraryPath)
+	{
+		if (!m_executionPlan.compiled() && !build())
+			return make_unexpected(m_buildErrors.front());
+
+		auto executor = NativeExecutor::load(libraryPath, m_executionPlan);
+		if (!executor)
+			return make_unexpected(executor.error());
+
+		m_nativeExecutor = std::move(executor.value());
+		return {};
+	}
+
+	void FlowScript::unloadNative()
+	{
+		m_nativeExecutor.reset();
+	}
+
+	bool FlowScript::nativeLoaded() const noexcept
+	{
+		return m_nativeExecutor != nullptr;
+	}
+
+	void FlowScript::setProfiler(std::shared_ptr<Profiler> profiler)
+	{
+		m_profiler = std::move(profiler);
+		m_executionPlan.setProfiler(m_profiler.get());
+	}
+
+	const std::shared_ptr<Profiler>& FlowScript::profiler() const noexcept
+	{
+		return m_profiler;
+	}
+
+	const ExecutionPlan& FlowScript::executionPlan() const noexcept
+	{
+		return m_executionPlan;
+	}
+
+	nf::Node* FlowScript::findNode(NodeHandle node) const
+	{
+		std::pair<int, size_t> pos;
+		return findNode(node, pos);
+	}
+
+	bool FlowScript::hasNode(NodeHandle node) const
+	{
+		return findNode(node) != nullptr;
+	}
+
+	NodeHandle FlowScript::findHandle(UUID uuid) const
+	{
+		auto it = m_uuidIndex.find(uuid);
+		return (it != m_uuidIndex.end()) ? it->second : NodeHandle{};
 	}
 
 	Expected<NodeHandle, Error> FlowScript::spawnNode(const std::string& namePath)
@@ -46,9 +306,10 @@ namespace nf
 		std::pair<int, size_t> pos;
 		auto foundNode = findNode(node, pos);
 
-		if (!foundNode)
+		if (!foundNode || foundNode == m_startNode)
 			return false;
 
+		invalidateExecutionPlan();
 		foundNode->onDestroy();
 
 		NodeArchetype archetype = foundNode->getArchetype();
@@ -65,9 +326,25 @@ namespace nf
 			flowNode->breakFlow(FlowDirection::Next);
 
 			if (auto flowBefore = flowNode->getExecBefore())
-				flowBefore->breakFlow(FlowDirection::Next);
+			{
+				// This node might be linked to one of the additional exits instead (ex. IfElseNode)
+				if (flowBefore->getExecNext() == flowNode)
+					flowBefore->breakFlow(FlowDirection::Next);
+				for (FlowPort* port : flowBefore->additionalFlowPorts())
+				{
+					if (port->execLink.targetNode == flowNode)
+						port->execLink.breakLink();
+				}
+			}
 			flowNode->breakFlow(FlowDirection::Before);
 
+			for (FlowPort* port : flowNode->additionalFlowPorts())
+			{
+				if (auto flowTo = port->execLink.targetNode)
+					flowTo->breakFlow(FlowDirection::Before);
+				port->execLink.breakLink();
+			}
+
 			NF_ASSERT(flowNode->getExecNext() == nullptr, "Error");
 			NF_ASSERT(flowNode->getExecBefore() == nullptr, "Error");
 		}
@@ -81,10 +358,34 @@ namespace nf
 
 		NF_ASSERT(debugAllConnectionsRemovedTo(foundNode), "Error");
 
+		removeEventSubscriptions(*foundNode);
+		for (const auto& oPort : foundNode->getOutputPortList())
+			m_observedOutputs.erase(&oPort);
+
+		// Bumping the generation turns all handles to the node stale
+		NodeSlot& slot = m_nodeSlots[node.index()];
+		slot.node = nullptr;
+		slot.generation++;
+		m_freeSlots.push_back(node.index());
+		m_uuidIndex.erase(foundNode->uuid());
+
+		// The last node takes over the freed position, so removing doesn't shift the whole list
+		auto removeAt = [&](auto& nodes) {
+			if (pos.second != nodes.size() - 1)
+			{
+				nodes[pos.second] = std::move(nodes.back());
+				m_nodeSlots[nodes[pos.second]->handle().index()].pos.second = pos.second;
+			}
+			nodes.pop_back();
+		};
+
 		if (pos.first == 0)
-			m_callablesNodes.erase(m_callablesNodes.begin() + pos.second);
+			removeAt(m_callablesNodes);
 		else
-			m_variableNodes.erase(m_variableNodes.begin() + pos.second);
+			removeAt(m_variableNodes);
+
+		if (m_portTable.fragmented())
+			m_portTable.compact();
 
 		return true;
 
@@ -119,36 +420,38 @@ namespace nf
 	*/
 
 	
-	Expected<void, ConnectionError> FlowScript::connectPorts(NodeHandle outNodeUUID, PortIndex outPort, 
-															 NodeHandle inNodeUUID, PortIndex inPort, 
+	Expected<void, ConnectionError> FlowScript::connectPorts(NodeHandle outHandle, PortIndex outPort, 
+															 NodeHandle inHandle, PortIndex inPort, 
 															 ConversionPolicy conv /*= ConversionPolicy::DontAddConversion*/)
 	{
 		NF_UNUSED(conv);
 
-		auto outNode = findNode(outNodeUUID);
-		auto inNode = findNode(inNodeUUID);
+		auto outNode = findNode(outHandle);
+		auto inNode = findNode(inHandle);
 
 		if (!outNode || ! inNode)
 			return make_unexpected(ConnectionError::UnknownNode);
 
+		invalidateExecutionPlan();
 		return outNode->makeConnection(outPort, *inNode, inPort);
 	}
 
-	bool FlowScript::disconnectPorts(NodeHandle outNodeUUID, PortIndex outPort, NodeHandle inNodeUUID, PortIndex inPort)
+	bool FlowScript::disconnectPorts(NodeHandle outHandle, PortIndex outPort, NodeHandle inHandle, PortIndex inPort)
 	{
-		auto outNode = findNode(outNodeUUID);
-		auto inNode = findNode(inNodeUUID);
+		auto outNode = findNode(outHandle);
+		auto inNode = findNode(inHandle);
 
 		if (!outNode || !inNode)
 			return false;
 
+		invalidateExecutionPlan();
 		return outNode->breakConnection(outPort, *inNode, inPort);
 	}
 
-	bool FlowScript::connectFlow(NodeHandle outNodeUUID, NodeHandle inNodeUUID)
+	bool FlowScript::connectFlow(NodeHandle outHandle, NodeHandle inHandle)
 	{
-		auto outNode = findNode(outNodeUUID);
-		auto inNode = findNode(inNodeUUID);
+		auto outNode = findNode(outHandle);
+		auto inNode = findNode(inHandle);
 
 		if (!outNode || !inNode)
 			return false;
@@ -167,6 +470,7 @@ namespace nf
 		auto outFlowNode = static_cast<FlowNode*>(outNode);
 		auto inFlowNode = static_cast<FlowNode*>(inNode);
 
+		invalidateExecutionPlan();
 		outFlowNode->setExecNext(*inFlowNode);
 		inFlowNode->setExecBefore(*outFlowNode);
 
@@ -178,6 +482,41 @@ namespace nf
 		return true;
 	}
 
+	bool FlowScript::connectFlow(NodeHandle outHandle, PortIndex outFlowPort, NodeHandle inHandle)
+	{
+		if (outFlowPort == 0)
+			return connectFlow(outHandle, inHandle);
+
+		auto outNode = findNode(outHandle);
+		auto inNode = findNode(inHandle);
+
+		if (!outNode || !inNode || outFlowPort < 0)
+			return false;
+
+		NodeArchetype outNodeType = outNode->getArchetype();
+		NodeArchetype inNodeType = inNode->getArchetype();
+
+		// Only FlowNodes and their childs can have flow links
+		if (outNodeType == NodeArchetype::DataNode || outNodeType == NodeArchetype::Node ||
+			inNodeType == NodeArchetype::DataNode || inNodeType == NodeArchetype::Node)
+			return false;
+
+		NF_ASSERT(dynamic_cast<FlowNode*>(outNode) != nullptr, "Well we have a problem");
+		NF_ASSERT(dynamic_cast<FlowNode*>(inNode) != nullptr, "Well we have a problem");
+
+		auto outFlowNode = static_cast<FlowNode*>(outNode);
+		auto inFlowNode = static_cast<FlowNode*>(inNode);
+
+		auto flowPorts = outFlowNode->additionalFlowPorts();
+		if (static_cast<size_t>(outFlowPort) > flowPorts.size())
+			return false;
+
+		invalidateExecutionPlan();
+		flowPorts[outFlowPort - 1]->execLink.makeLink(inFlowNode);
+		inFlowNode->setExecBefore(*outFlowNode);
+		return true;
+	}
+
 	/*
 	nf::ExpectedRef<DataNode, Error> FlowScript::spawnType(const std::string& namePath)
 	{
@@ -224,11 +563,11 @@ namespace nf
 	*/
 	
 
-	bool FlowScript::disconnectFlow(NodeHandle outNodeUUID, NodeHandle inNodeUUID)
+	bool FlowScript::disconnectFlow(NodeHandle outHandle, NodeHandle inHandle)
 	{
 
-		auto outNode = findNode(outNodeUUID);
-		auto inNode = findNode(inNodeUUID);
+		auto outNode = findNode(outHandle);
+		auto inNode = findNode(inHandle);
 
 		if (!outNode || !inNode)
 			return false;
@@ -248,11 +587,24 @@ namespace nf
 		auto outFlowNode = static_cast<FlowNode*>(outNode);
 		auto inFlowNode = static_cast<FlowNode*>(inNode);
 
+		invalidateExecutionPlan();
 		inFlowNode->breakFlow(FlowDirection::Before);
-		outFlowNode->breakFlow(FlowDirection::Next);
+
+		// The link might start at one of the additional exits instead (ex. IfElseNode)
+		bool additionalExit = false;
+		for (FlowPort* port : outFlowNode->additionalFlowPorts())
+		{
+			if (port->execLink.targetNode == inFlowNode)
+			{
+				port->execLink.breakLink();
+				additionalExit = true;
+			}
+		}
+		if (!additionalExit)
+			outFlowNode->breakFlow(FlowDirection::Next);
 
 		NF_ASSERT(inFlowNode->getExecBefore() == nullptr, "Error");
-		NF_ASSERT(outFlowNode->getExecNext() == nullptr, "Error");
+		NF_ASSERT(additionalExit || outFlowNode->getExecNext() == nullptr, "Error");
 
 		return true;
 	}
@@ -276,29 +628,44 @@ namespace nf
 		std::stringstream stream(str);
 		auto success = foundNode->streamOutput(index, StreamFlag::ReadFrom, stream);
 		NF_ASSERT(success, "Node did not implement streamOutput(...");
+		if (success)
+			foundNode->markOutputChanged(index);
 	}
 
-	nf::Node* FlowScript::findNode(NodeHandle uuid, std::pair<int, size_t>& pos) const
+	nf::Node* FlowScript::findNode(NodeHandle node, std::pair<int, size_t>& pos) const
 	{
-		for (size_t i = 0; i < m_callablesNodes.size(); i++)
+		if (node.index() >= m_nodeSlots.size())
+			return nullptr;
+
+		const NodeSlot& slot = m_nodeSlots[node.index()];
+		if (slot.generation != node.generation())
+			return nullptr;
+
+		pos = slot.pos;
+		return slot.node;
+	}
+
+	NodeHandle FlowScript::insertNode(Node& node, std::pair<int, size_t> pos)
+	{
+		std::uint32_t index;
+		if (!m_freeSlots.empty())
 		{
-			if (m_callablesNodes[i]->uuid() == uuid) {
-				pos.first = 0;
-				pos.second = i;
-				return m_callablesNodes[i].get();
-			}
+			index = m_freeSlots.back();
+			m_freeSlots.pop_back();
 		}
-
-		for (size_t j = 0; j < m_variableNodes.size(); j++)
+		else
 		{
-			if (m_variableNodes[j]->uuid() == uuid) {
-				pos.first = 1;
-				pos.second = j;
-				return m_variableNodes[j].get();
-			}
+			index = static_cast<std::uint32_t>(m_nodeSlots.size());
+			m_nodeSlots.emplace_back();
 		}
 
-		return nullptr;
+		NodeSlot& slot = m_nodeSlots[index];
+		slot.node = &node;
+		slot.pos = pos;
+
+		node.m_handle = NodeHandle(index, slot.generation);
+		m_uuidIndex.emplace(node.uuid(), node.m_handle);
+		return node.m_handle;
 	}
 
 	nf::Node* FlowScript::findPortConversionNode(typeid_t fromType, typeid_t toType) const
@@ -319,25 +686,15 @@ namespace nf
 
 	bool FlowScript::isUUIDUnique(UUID uuid) const
 	{
-		for (const auto& node : m_callablesNodes)
-		{
-			if (node->uuid() == uuid)
-				return false;
-		}
-
-		for (const auto& node : m_variableNodes)
-		{
-			if (node->uuid() == uuid)
-				return false;
-		}
-		return true;
+		return !m_uuidIndex.contains(uuid);
 	}
 
 	Expected<NodeHandle, Error> FlowScript::createNode(const std::string& namePath)
 	{
 		auto& creators = m_scriptModule->nodeCreators();
 		auto creator = creators.at(namePath);
-		auto instance = creator();
+		auto instance = creator(m_nodePool);
+		instance->setPortTable(m_portTable);
 
 		while (!isUUIDUnique(instance->uuid()))
 		{
@@ -348,9 +705,11 @@ namespace nf
 		if (auto setupSuccess = instance->setup(); !setupSuccess)
 			return make_unexpected(setupSuccess.error());
 
+		indexEventSubscriptions(*instance);
+		const NodeHandle handle = insertNode(*instance, { 0, m_callablesNodes.size() });
 		m_callablesNodes.push_back(std::move(instance));
 
-		return m_callablesNodes[m_callablesNodes.size() - 1]->uuid();
+		return handle;
 	}
 
 
@@ -360,7 +719,8 @@ namespace nf
 	{
 		auto& creators = m_scriptModule->dataCreators();
 		auto creator = creators.at(namePath);
-		auto instance = creator();
+		auto instance = creator(m_nodePool);
+		instance->setPortTable(m_portTable);
 
 		while (!isUUIDUnique(instance->uuid()))
 		{
@@ -371,39 +731,63 @@ namespace nf
 		if (auto setupSuccess = instance->setup(); !setupSuccess)
 			return make_unexpected(setupSuccess.error());
 
+		indexEventSubscriptions(*instance);
+		const NodeHandle handle = insertNode(*instance, { 1, m_variableNodes.size() });
 		m_variableNodes.push_back(std::move(instance));
 
-		return m_variableNodes[m_variableNodes.size() - 1]->uuid();
+		return handle;
 	}
 
 	bool FlowScript::debugAllConnectionsRemovedTo(nf::Node* node) const
 	{
-		for (const auto& cNode : m_callablesNodes) {
-			for (const auto& iPort : cNode->getInputPortList()) {
-				if (iPort.link().targetNode == node)
-					return false;
-			}
-			for (const auto& oPort : cNode->getOutputPortList()) {
-				for (const auto& oLink : oPort.links()) {
-					if (oLink.targetNode == node)
-						return false;
-				}
-			}
+		for (const PortLink& link : m_portTable.inputLinks()) {
+			if (link.targetNode == node)
+				return false;
 		}
 
-		for (const auto& vNode : m_variableNodes) {
-			for (const auto& iPort : vNode->getInputPortList()) {
-				if (iPort.link().targetNode == node)
+		for (const auto& links : m_portTable.outputLinks()) {
+			for (const PortLink& link : links) {
+				if (link.targetNode == node)
 					return false;
 			}
-			for (const auto& oPort : vNode->getOutputPortList()) {
-				for (const auto& oLink : oPort.links()) {
-					if (oLink.targetNode == node)
-						return false;
-				}
-			}
 		}
 		return true;
 	}
 
+	void FlowScript::invalidateExecutionPlan()
+	{
+		// Async work still references the coroutine frames, so it must finish before they are destroyed
+		m_latentQueue.cancel();
+		for (const auto& step : m_executionPlan.steps())
+		{
+			if (step.latent)
+				static_cast<LatentFlowNode*>(step.node)->cancelLatent();
+		}
+		m_suspendedStep = -1;
+
+		m_nativeExecutor.reset();
+		m_parallelScheduler.clear();
+		m_executionPlan.clear();
+	}
+
+	void FlowScript::indexEventSubscriptions(Node& node)
+	{
+		for (typeid_t eventType : node.eventSubscriptions())
+			m_eventSubscribers[eventType].push_back(&node);
+	}
+
+	void FlowScript::removeEventSubscriptions(const Node& node)
+	{
+		for (typeid_t eventType : node.eventSubscriptions())
+		{
+			auto it = m_eventSubscribers.find(eventType);
+			if (it == m_eventSubscribers.end())
+				continue;
+
+			std::erase(it->second, &node);
+			if (it->second.empty())
+				m_eventSubscribers.erase(it);
+		}
+	}
+
 }
\ No newline at end of file
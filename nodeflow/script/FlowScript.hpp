@@ -35,12 +35,23 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 #include <string>
 #include <memory>
+#include <span>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory_resource>
 
 #include "typedefs.hpp"
 #include "core/Error.hpp"
 #include "utility/Expected.hpp"
 #include "script/FlowModule.hpp"
+#include "script/ExecutionPlan.hpp"
+#include "script/ParallelScheduler.hpp"
+#include "script/NativeExecutor.hpp"
+#include "script/LatentQueue.hpp"
+#include "utility/ThreadPool.hpp"
 #include "nodes/EventNode.hpp"
+#include "nodes/LatentFlowNode.hpp"
 
 namespace nf
 {	
@@ -50,24 +61,27 @@ namespace nf
 		NodeNameFalseCategory
 	};
 
-	using NodeHandle = UUID;
-
 
 	class FlowScript
 	{
 
 	public:
-		FlowScript(std::shared_ptr<FlowModule> scriptModule)
-			: m_scriptModule(std::move(scriptModule))
-		{}
+		FlowScript(std::shared_ptr<FlowModule> scriptModule);
+
+		~FlowScript();
 
 // 		Node* variables() const;
 		
-		void precomputeExecutionOrder();
+		/**
+		 * @brief Compiles the flow starting at the StartEventNode into the ExecutionPlan used by run().
+		 * @return nothing or an Error if the flow or the data dependencies contain a cycle
+		*/
+		Expected<void, Error> precomputeExecutionOrder();
 
 		/**
-		 * @brief Broadcasts custom event to all nodes within script.
-		 Nodes can react on event by overriding onEvent method.
+		 * @brief Broadcasts custom event to all nodes within script that subscribed to 'EventType'.
+		 Nodes can react on event by calling subscribeEvent() in setup and overriding onEvent method.
+		 Latent nodes waiting for the event are resumed on the next update().
 		 * @tparam EventType 
 		 * @tparam ...EventArgs 
 		 * @param ...eventArgs 
@@ -76,21 +90,34 @@ namespace nf
 		void broadcastEvent(EventArgs&&... eventArgs)
 		{
 			EventType event(std::forward<EventArgs>(eventArgs)...);
-			for (auto& node : m_callablesNodes)
-				node->onEvent(&event);
+			if (auto it = m_eventSubscribers.find(EventType::type); it != m_eventSubscribers.end())
+			{
+				for (Node* node : it->second)
+					node->onEvent(&event);
+			}
+			m_latentQueue.notifyEvent(event);
 		}
 
 
+		/**
+		 * @brief Returns the node 'node' refers to or nullptr if the handle is stale
+		*/
 		nf::Node* findNode(NodeHandle node) const;
 
-		bool hasNode(NodeHandle uuid) const;
+		bool hasNode(NodeHandle node) const;
+
+		/**
+		 * @brief Resolves the persistent UUID of a node (ex. read from a saved script) to its runtime handle.
+		 * @return an invalid handle if no node has this UUID
+		*/
+		NodeHandle findHandle(UUID uuid) const;
 
 		template<typename NodeType, class Callable>
 		void forEach(Callable callable)
 		{
 			static constexpr typeid_t nodeTypeID = type_id<NodeType>();
 
-			std::for_each(m_callablesNodes.begin(), m_callablesNodes.end(), [](std::unique_ptr<FlowNode>& node) 
+			std::for_each(m_callablesNodes.begin(), m_callablesNodes.end(), [](NodePtr<FlowNode>& node) 
 			{
 			});
 		}
@@ -100,14 +127,20 @@ namespace nf
 
 		bool removeNode(NodeHandle node);
 
-		Expected<void, ConnectionError> connectPorts(NodeHandle outNodeUUID, PortIndex outPort, 
-													 NodeHandle inNodeUUID, PortIndex inPort, 
+		Expected<void, ConnectionError> connectPorts(NodeHandle outHandle, PortIndex outPort, 
+													 NodeHandle inHandle, PortIndex inPort, 
 													 ConversionPolicy conv = ConversionPolicy::DontAddConversion);
 
 
-		bool disconnectPorts(NodeHandle outNodeUUID, PortIndex outPort, NodeHandle inNodeUUID, PortIndex inPort);
+		bool disconnectPorts(NodeHandle outHandle, PortIndex outPort, NodeHandle inHandle, PortIndex inPort);
+
+		bool connectFlow(NodeHandle outHandle, NodeHandle inHandle);
 
-		bool connectFlow(NodeHandle outNodeUUID, NodeHandle inNodeUUID);
+		/**
+		 * @brief Connects a specific exit of a node, ex. the 'False' exit of an IfElseNode or the 'Body' of a loop.
+		 * @param outFlowPort 0 is the default exit, additional flow ports (see FlowNode::additionalFlowPorts()) follow
+		*/
+		bool connectFlow(NodeHandle outHandle, PortIndex outFlowPort, NodeHandle inHandle);
 
 		bool disconnectFlow(NodeHandle outNode, NodeHandle inNode);
 
@@ -125,9 +158,133 @@ namespace nf
 
 		StartEventNode& startEventNode() const;
 		
+		/**
+		 * @brief Precomputes the execution order and lets every scheduled node validate itself via onBuild().
+		 * Pure nodes that only read constant variables are evaluated once and removed from the plan
+		 * (see ExecutionPlan::foldConstants()). Any change to the script's connections invalidates the build.
+		 * @return 'false' if the build failed. Errors can be retrieved by buildErrors()
+		*/
 		bool build();
 
+		/**
+		 * @brief Executes the compiled ExecutionPlan once. Builds the script if necessary.
+		 * Returns early if a LatentFlowNode suspended, the execution is then continued by update().
+		 * Does nothing while a previous execution is suspended.
+		*/
 		void run();
+
+		/**
+		 * @brief Drives the latent nodes: resumes coroutines whose timer expired, whose event was broadcast or
+		 * whose async work completed, and continues the suspended execution once its latent node completed.
+		 * Meant to be called periodically from the event loop of the application.
+		 * @return number of resumed coroutines
+		*/
+		size_t update();
+
+		/**
+		 * @brief Returns 'true' while an execution waits for a LatentFlowNode
+		*/
+		bool suspended() const noexcept;
+
+		/**
+		 * @brief Sets the pool running the async work of latent nodes. Defaults to a pool shared by all scripts.
+		*/
+		void setAsyncPool(std::shared_ptr<ThreadPool> pool);
+
+		/**
+		 * @brief Executes the compiled ExecutionPlan once for 'count' records. Builds the script if necessary.
+		 * Every output port read by the script provides either a column (see setOutputColumn()) or a single
+		 * value broadcast to all records. Results are read via outputColumn(). Only FunctorNodes and
+		 * ConversionNodes can be executed in batch mode.
+		*/
+		Expected<void, Error> runBatch(size_t count);
+
+		/**
+		 * @brief Assigns one value per record to an output port, typically the one of a DataNode.
+		 * @return 'false' if the node does not exist or 'T' is not the type of the port
+		*/
+		template<typename T>
+		bool setOutputColumn(NodeHandle node, PortIndex index, std::span<const T> values);
+
+		/**
+		 * @brief Returns the values of an output port computed by the last runBatch().
+		 * @return an empty span if the node does not exist or 'T' is not the type of the port
+		*/
+		template<typename T>
+		std::span<const T> outputColumn(NodeHandle node, PortIndex index) const;
+
+		const std::vector<Error>& buildErrors() const noexcept;
+
+		/**
+		 * @brief Selects how run() executes the script. Invalidates the current build.
+		 * ExecutionPolicy::Parallel dispatches independent FunctorNodes and ConversionNodes
+		 * onto a work-stealing thread pool owned by the script.
+		 * @param workerCount number of worker threads. 0 uses all hardware threads
+		*/
+		void setExecutionPolicy(ExecutionPolicy policy, size_t workerCount = 0);
+
+		ExecutionPolicy executionPolicy() const noexcept;
+
+		/**
+		 * @brief When enabled, run() skips pure nodes (see Node::isPure()) whose upstream output ports
+		 * didn't change since their last execution. Changes are tracked through the version counter of
+		 * each OutputPortHandle, which is increased by DataNode::setData, setNodeOutputFromStr and any recompute.
+		*/
+		void setIncrementalEvaluation(bool enabled);
+
+		bool incrementalEvaluation() const noexcept;
+
+		/**
+		 * @brief When enabled, build() removes pure nodes from the plan whose outputs never reach a node with side effects,
+		 * a flow node or an observed output port. Such nodes are not validated by onBuild() either, so half-connected
+		 * leftovers don't fail the build. Invalidates the current build.
+		*/
+		void setDeadNodeElimination(bool enabled);
+
+		bool deadNodeElimination() const noexcept;
+
+		/**
+		 * @brief Declares an output port that is read from outside of the script (ex. via outputColumn() or nodeOutputAsStr()).
+		 * Keeps the nodes computing it alive during dead node elimination.
+		 * @return 'false' if the node or port does not exist
+		*/
+		bool observeOutput(NodeHandle node, PortIndex index);
+
+		/**
+		 * @brief Returns all callable nodes the last build() didn't schedule: nodes not reachable from the flow
+		 * and nodes removed by dead node elimination.
+		*/
+		const std::vector<NodeHandle>& prunedNodes() const noexcept;
+
+		/**
+		 * @brief Generates a C++ translation unit executing the script like run(), without any interpretive overhead.
+		 * Builds the script if necessary. Compile the result as shared library and pass it to loadNative().
+		 * Every FunctorNode must call a function declared via FlowModule::nativizeFunction() returning a default
+		 * constructible value. Other than that, only IfElse and loop nodes can be exported.
+		 * @return the source code or an Error if the script contains a node that can't be exported
+		*/
+		Expected<std::string, Error> exportNative();
+
+		/**
+		 * @brief Loads a shared library compiled from exportNative() and lets run() execute it instead of the ExecutionPlan.
+		 * The library must have been generated from the current build. Any change invalidating the build unloads it again.
+		 * Incremental evaluation and the execution policy don't apply to native scripts.
+		*/
+		Expected<void, Error> loadNative(const std::string& libraryPath);
+
+		void unloadNative();
+
+		bool nativeLoaded() const noexcept;
+
+		/**
+		 * @brief Records the duration of every node executed by run() and runBatch() into 'profiler'.
+		 * Covers the nodes executed by the ExecutionPolicy::Parallel workers as well. nullptr disables profiling.
+		*/
+		void setProfiler(std::shared_ptr<Profiler> profiler);
+
+		const std::shared_ptr<Profiler>& profiler() const noexcept;
+
+		const ExecutionPlan& executionPlan() const noexcept;
 		
 		/*
 		ExpectedRef<FlowNode, Error> spawnNode(const std::string& namePath);
@@ -143,7 +300,22 @@ namespace nf
 		*/
 	private:
 
-		nf::Node* findNode(NodeHandle uuid, std::pair<int, size_t>& pos) const;
+		/**
+		 * @brief Entry of the slot map NodeHandles index into
+		*/
+		struct NodeSlot
+		{
+			Node* node = nullptr; // nullptr while the slot is free
+			std::uint32_t generation = 0;
+			std::pair<int, size_t> pos; // Position in m_callablesNodes (0) or m_variableNodes (1)
+		};
+
+		nf::Node* findNode(NodeHandle node, std::pair<int, size_t>& pos) const;
+
+		/**
+		 * @brief Assigns a slot and the handle referring to it to a node stored at 'pos'
+		*/
+		NodeHandle insertNode(Node& node, std::pair<int, size_t> pos);
 
 		nf::Node* findPortConversionNode(typeid_t fromType, typeid_t toType) const;
 
@@ -156,12 +328,71 @@ namespace nf
 
 		bool debugAllConnectionsRemovedTo(nf::Node* node) const;
 
+		void invalidateExecutionPlan();
+
+		void indexEventSubscriptions(Node& node);
+
+		void removeEventSubscriptions(const Node& node);
+
+
+	private:
+		// Nodes and their port tables, released in bulk with the script. Declared first, so it outlives the nodes.
+		// Pools per block size let removed nodes' memory be reused by nodes of the same size.
+		std::pmr::unsynchronized_pool_resource m_nodePool;
+		// Ports of all nodes. Outlives the nodes as well, as they give their rows back on destruction.
+		PortTable m_portTable;
 
 	public :
-		std::vector<std::unique_ptr<FlowNode>> m_callablesNodes;
-		std::vector<std::unique_ptr<DataNode>> m_variableNodes;
+		std::vector<NodePtr<FlowNode>> m_callablesNodes;
+		std::vector<NodePtr<DataNode>> m_variableNodes;
 		std::shared_ptr<FlowModule> m_scriptModule;
 
-// 		std::vector<BuildError> errorList
+	private:
+		std::vector<NodeSlot> m_nodeSlots;
+		std::vector<std::uint32_t> m_freeSlots;
+		std::unordered_map<UUID, NodeHandle> m_uuidIndex;
+		StartEventNode* m_startNode = nullptr;
+		ExecutionPlan m_executionPlan;
+		LatentQueue m_latentQueue;
+		std::int32_t m_suspendedStep = -1; // Step of the LatentFlowNode the current execution waits for
+		ParallelScheduler m_parallelScheduler;
+		std::unique_ptr<ThreadPool> m_threadPool; // Destroyed first, so no worker outlives the scheduler
+		ExecutionPolicy m_executionPolicy = ExecutionPolicy::Sequential;
+		std::vector<Error> m_buildErrors;
+		std::unordered_map<typeid_t, std::vector<Node*>> m_eventSubscribers; // Event type -> nodes handling it
+		std::unordered_set<const OutputPortHandle*> m_observedOutputs;
+		std::vector<NodeHandle> m_prunedNodes;
+		bool m_deadNodeElimination = false;
+		std::unique_ptr<NativeExecutor> m_nativeExecutor; // Replaces the ExecutionPlan in run() once loaded
+		std::shared_ptr<Profiler> m_profiler;
 	};
+
+	template<typename T>
+	bool FlowScript::setOutputColumn(NodeHandle node, PortIndex index, std::span<const T> values)
+	{
+		auto foundNode = findNode(node);
+		if (!foundNode)
+			return false;
+
+		auto column = foundNode->outputColumn<T>(index);
+		if (!column)
+			return false;
+
+		column->assign(values);
+		foundNode->markOutputChanged(index);
+		return true;
+	}
+
+	template<typename T>
+	std::span<const T> FlowScript::outputColumn(NodeHandle node, PortIndex index) const
+	{
+		auto foundNode = findNode(node);
+		if (!foundNode)
+			return {};
+
+		auto column = foundNode->outputColumn<T>(index);
+		if (!column)
+			return {};
+		return column->span();
+	}
 }
@@ -0,0 +1,127 @@
+#include "script/LatentQueue.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace nf
+{
+	namespace
+	{
+		std::shared_ptr<ThreadPool> sharedAsyncPool()
+		{
+			// Latent work mostly waits on IO, a handful of threads serves any number of scripts
+			static std::shared_ptr<ThreadPool> pool = std::make_shared<ThreadPool>(
+				std::max<size_t>(2, std::thread::hardware_concurrency() / 2));
+			return pool;
+		}
+	}
+
+	LatentQueue::~LatentQueue()
+	{
+		cancel();
+	}
+
+	void LatentQueue::resumeAt(Clock::time_point deadline, std::coroutine_handle<> handle)
+	{
+		m_timers.push_back({ deadline, handle });
+		std::push_heap(m_timers.begin(), m_timers.end(), std::greater<>{});
+	}
+
+	void LatentQueue::resumeOnEvent(typeid_t type, EventAcceptor accept, void* awaiter, std::coroutine_handle<> handle)
+	{
+		m_eventWaiters.push_back({ type, accept, awaiter, handle });
+	}
+
+	void LatentQueue::notifyEvent(const FlowEvent& event)
+	{
+		const typeid_t type = event.eventType();
+		auto waiting = std::partition(m_eventWaiters.begin(), m_eventWaiters.end(),
+			[type](const EventWaiter& waiter) { return waiter.type != type; });
+
+		for (auto it = waiting; it != m_eventWaiters.end(); ++it)
+		{
+			it->accept(it->awaiter, event);
+			pushReady(it->handle);
+		}
+		m_eventWaiters.erase(waiting, m_eventWaiters.end());
+	}
+
+	void LatentQueue::submitAsync(ThreadPool::Task task)
+	{
+		if (!m_asyncPool)
+			m_asyncPool = sharedAsyncPool();
+
+		{
+			std::lock_guard lock(m_readyMutex);
+			m_inFlight++;
+		}
+		m_asyncPool->submit(task);
+	}
+
+	void LatentQueue::finishAsync(std::coroutine_handle<> handle)
+	{
+		// Notified while locked, so cancel() can't return (and the queue be destroyed) before we are done
+		std::lock_guard lock(m_readyMutex);
+		m_ready.push_back(handle);
+		if (--m_inFlight == 0)
+			m_asyncDone.notify_all();
+	}
+
+	size_t LatentQueue::update()
+	{
+		std::vector<std::coroutine_handle<>> resumable;
+		{
+			std::lock_guard lock(m_readyMutex);
+			resumable.swap(m_ready);
+		}
+
+		const auto now = Clock::now();
+		while (!m_timers.empty() && m_timers.front().deadline <= now)
+		{
+			std::pop_heap(m_timers.begin(), m_timers.end(), std::greater<>{});
+			resumable.push_back(m_timers.back().handle);
+			m_timers.pop_back();
+		}
+
+		// Resumed coroutines may suspend again and register new waiters, which are handled on the next update
+		for (auto handle : resumable)
+			handle.resume();
+
+		return resumable.size();
+	}
+
+	void LatentQueue::cancel()
+	{
+		m_timers.clear();
+		m_eventWaiters.clear();
+
+		std::unique_lock lock(m_readyMutex);
+		m_asyncDone.wait(lock, [this] { return m_inFlight == 0; });
+		m_ready.clear();
+	}
+
+	bool LatentQueue::empty() const
+	{
+		std::lock_guard lock(m_readyMutex);
+		return m_timers.empty() && m_eventWaiters.empty() && m_ready.empty() && m_inFlight == 0;
+	}
+
+	std::optional<LatentQueue::Clock::time_point> LatentQueue::nextDeadline() const
+	{
+		if (m_timers.empty())
+			return std::nullopt;
+		return m_timers.front().deadline;
+	}
+
+	void LatentQueue::setAsyncPool(std::shared_ptr<ThreadPool> pool)
+	{
+		m_asyncPool = std::move(pool);
+	}
+
+	void LatentQueue::pushReady(std::coroutine_handle<> handle)
+	{
+		std::lock_guard lock(m_readyMutex);
+		m_ready.push_back(handle);
+	}
+}
@@ -0,0 +1,143 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <chrono>
+#include <optional>
+#include <coroutine>
+
+#include "typedefs.hpp"
+#include "core/FlowEvent.hpp"
+#include "utility/ThreadPool.hpp"
+
+namespace nf
+{
+	/**
+	 * @brief Event loop of the latent nodes of a FlowScript.
+	 * Holds suspended coroutines until their timer expired, their event was broadcast or their async work completed.
+	 * Coroutines are only resumed by update(), so they always continue on the thread driving the script.
+	*/
+	class LatentQueue
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+		using EventAcceptor = void(*)(void* awaiter, const FlowEvent& event);
+
+	public:
+		LatentQueue() = default;
+		~LatentQueue();
+
+		LatentQueue(const LatentQueue&) = delete;
+		LatentQueue& operator=(const LatentQueue&) = delete;
+
+		void resumeAt(Clock::time_point deadline, std::coroutine_handle<> handle);
+
+		/**
+		 * @brief Resumes 'handle' on the next update() after an event of 'type' was passed to notifyEvent().
+		 * 'accept' is called with the event first, so the awaiter can copy it.
+		*/
+		void resumeOnEvent(typeid_t type, EventAcceptor accept, void* awaiter, std::coroutine_handle<> handle);
+
+		void notifyEvent(const FlowEvent& event);
+
+		/**
+		 * @brief Runs a task on the async pool. The task must call finishAsync() once done. Thread-safe.
+		*/
+		void submitAsync(ThreadPool::Task task);
+
+		/**
+		 * @brief Resumes 'handle' on the next update(). Called from the async pool.
+		*/
+		void finishAsync(std::coroutine_handle<> handle);
+
+		/**
+		 * @brief Resumes every coroutine whose timer expired, whose event arrived or whose async work completed.
+		 * @return number of resumed coroutines
+		*/
+		size_t update();
+
+		/**
+		 * @brief Waits for all async work in flight and drops every pending coroutine without resuming it.
+		 * The coroutine frames are still owned (and destroyed) by their LatentTask.
+		*/
+		void cancel();
+
+		bool empty() const;
+
+		/**
+		 * @brief Earliest expiring timer. Event loops may sleep until then if nothing else is pending.
+		*/
+		std::optional<Clock::time_point> nextDeadline() const;
+
+		/**
+		 * @brief Pool running the work of LatentFlowNode::runAsync(). Defaults to a pool shared by all scripts.
+		*/
+		void setAsyncPool(std::shared_ptr<ThreadPool> pool);
+
+	private:
+		struct Timer
+		{
+			Clock::time_point deadline;
+			std::coroutine_handle<> handle;
+
+			bool operator>(const Timer& other) const { return deadline > other.deadline; }
+		};
+
+		struct EventWaiter
+		{
+			typeid_t type = 0;
+			EventAcceptor accept = nullptr;
+			void* awaiter = nullptr;
+			std::coroutine_handle<> handle;
+		};
+
+		void pushReady(std::coroutine_handle<> handle);
+
+	private:
+		std::vector<Timer> m_timers; // min-heap on deadline
+		std::vector<EventWaiter> m_eventWaiters;
+
+		// Shared with the async pool
+		mutable std::mutex m_readyMutex;
+		std::condition_variable m_asyncDone;
+		std::vector<std::coroutine_handle<>> m_ready;
+		size_t m_inFlight = 0;
+
+		std::shared_ptr<ThreadPool> m_asyncPool;
+	};
+}
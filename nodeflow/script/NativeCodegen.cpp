@@ -0,0 +1,253 @@
+#include "script/NativeCodegen.hpp"
+#include "core/Node.hpp"
+
+#include <format>
+#include <unordered_set>
+
+namespace nf
+{
+	namespace
+	{
+		// Resolves result and argument types from the address of the called function,
+		// so the generated code doesn't depend on the spelling of type names
+		constexpr auto helpers = R"(
+namespace
+{
+	template<typename F>
+	struct nf_signature;
+
+	template<typename R, typename... A>
+	struct nf_signature<R(*)(A...)>
+	{
+		using result = std::decay_t<R>;
+		using args = std::tuple<std::decay_t<A>...>;
+	};
+
+	template<typename R, typename... A>
+	struct nf_signature<R(*)(A...) noexcept> : nf_signature<R(*)(A...)> {};
+
+	template<auto F>
+	using nf_result_t = typename nf_signature<decltype(F)>::result;
+
+	template<auto F, std::size_t I>
+	using nf_arg_t = std::tuple_element_t<I, typename nf_signature<decltype(F)>::args>;
+}
+
+#if defined(_WIN32)
+#define NF_NATIVE_EXPORT extern "C" __declspec(dllexport)
+#else
+#define NF_NATIVE_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+)";
+	}
+
+	NativeCodegen::NativeCodegen(const ExecutionPlan& plan)
+		: m_plan(plan)
+	{
+		// Only steps entered by a jump need a label, all others are reached by falling through
+		const auto& steps = m_plan.steps();
+		m_targets.assign(steps.size(), 0);
+		for (std::uint32_t i = 0; i < steps.size(); i++)
+		{
+			if (steps[i].next != -1 && steps[i].next != static_cast<std::int32_t>(i + 1))
+				m_targets[steps[i].next] = 1;
+			if (steps[i].jump != -1)
+				m_targets[steps[i].jump] = 1;
+		}
+	}
+
+	Expected<NativeSource, Error> NativeCodegen::generate(const ExecutionPlan& plan)
+	{
+		NativeCodegen codegen(plan);
+		if (auto success = codegen.declareLocals(); !success)
+			return make_unexpected(success.error());
+
+		for (std::uint32_t i = 0; i < plan.steps().size(); i++)
+		{
+			if (auto success = codegen.emitStep(i); !success)
+				return make_unexpected(success.error());
+		}
+
+		// Ports written back are indexed after all ports read, the order doesn't matter to the code
+		std::ostringstream declarations;
+		std::ostringstream writeBack;
+		for (const OutputPortHandle* port : codegen.m_localOrder)
+		{
+			const Local& local = codegen.m_locals.at(port);
+			declarations << std::format("\t{} {}{{}};\n", local.type, local.name);
+			if (local.node->getArchetype() == NodeArchetype::Lang_ForLoop)
+				declarations << std::format("\tbool {}_running = false;\n", local.name);
+
+			writeBack << std::format("\t*static_cast<{}*>(ports[{}]) = {};\n", local.type, codegen.portIndex(*port), local.name);
+			codegen.m_source.written.emplace_back(local.node, local.index);
+		}
+
+		codegen.makeSignature();
+
+		std::ostringstream code;
+		code << "// Generated by nodeflow. Compile as shared library and load it via FlowScript::loadNative().\n";
+		code << "#include <cstddef>\n#include <tuple>\n#include <type_traits>\n";
+		for (const auto& header : codegen.m_headers)
+			code << std::format("#include \"{}\"\n", header);
+
+		code << helpers << "\n";
+		code << std::format("NF_NATIVE_EXPORT const char {}[] = \"{}\";\n\n", signatureSymbol, codegen.m_source.signature);
+		code << std::format("NF_NATIVE_EXPORT void {}(void* const* ports)\n{{\n", entryPoint);
+		code << "\t(void)ports;\n" << declarations.str() << "\n";
+		code << codegen.m_body.str();
+		code << "end:\n" << writeBack.str() << "\treturn;\n}\n";
+
+		codegen.m_source.code = code.str();
+		return std::move(codegen.m_source);
+	}
+
+	Expected<void, Error> NativeCodegen::declareLocals()
+	{
+		// Nodes folded by ExecutionPlan::foldConstants() have no step, their outputs are read from the ports
+		std::unordered_set<const Node*> declared;
+		for (const ExecutionStep& step : m_plan.steps())
+		{
+			const Node* node = step.node;
+			if (!declared.insert(node).second)
+				continue;
+
+			switch (node->getArchetype())
+			{
+			case NodeArchetype::Flow_FunctorNode:
+			{
+				const NativeSymbol* symbol = node->nativeSymbol();
+				if (symbol == nullptr)
+					return make_unexpected(Error(std::format("Node '{}' calls a function without native name (see FlowModule::nativizeFunction())", node->nodeName()), 137));
+
+				if (!symbol->header.empty())
+					m_headers.insert(symbol->header);
+
+				for (PortIndex i = 0; i < static_cast<PortIndex>(node->getOutputPortList().size()); i++)
+				{
+					const OutputPortHandle* port = &node->getOutputPortList()[i];
+					m_locals[port] = Local{ std::format("v{}", m_localOrder.size()), std::format("nf_result_t<&{}>", symbol->name), const_cast<Node*>(node), i };
+					m_localOrder.push_back(port);
+				}
+				break;
+			}
+			case NodeArchetype::Lang_ForLoop:
+			{
+				const OutputPortHandle* port = &node->getOutputPortList()[0];
+				m_locals[port] = Local{ std::format("v{}", m_localOrder.size()), "int", const_cast<Node*>(node), 0 };
+				m_localOrder.push_back(port);
+				break;
+			}
+			case NodeArchetype::Lang_IfElse:
+			case NodeArchetype::Lang_WhileLoop:
+				break;
+
+			default:
+				return make_unexpected(Error(std::format("Node '{}' can't be exported as native code", node->nodeName()), 137));
+			}
+		}
+		return {};
+	}
+
+	Expected<void, Error> NativeCodegen::emitStep(std::uint32_t index)
+	{
+		const ExecutionStep& step = m_plan.steps()[index];
+		const Node& node = *step.node;
+
+		if (m_targets[index])
+			m_body << label(static_cast<std::int32_t>(index)) << ":\n";
+
+		switch (node.getArchetype())
+		{
+		case NodeArchetype::Flow_FunctorNode:
+		{
+			const std::string& name = node.nativeSymbol()->name;
+			std::string arguments;
+			for (std::uint32_t i = 0; i < step.inputCount; i++)
+			{
+				if (i != 0)
+					arguments += ", ";
+				arguments += operand(step, i, std::format("nf_arg_t<&{}, {}>", name, i));
+			}
+
+			if (node.getOutputPortList().empty())
+				m_body << std::format("\t{}({});\n", name, arguments);
+			else
+				m_body << std::format("\t{} = {}({});\n", m_locals.at(&node.getOutputPortList()[0]).name, name, arguments);
+			break;
+		}
+		case NodeArchetype::Lang_IfElse:
+			// 'True' continues at 'next', 'False' jumps
+			m_body << std::format("\tif (!{}) goto {};\n", operand(step, 0, "bool"), label(step.jump));
+			break;
+
+		case NodeArchetype::Lang_WhileLoop:
+			m_body << std::format("\tif ({}) goto {};\n", operand(step, 0, "bool"), label(step.jump));
+			break;
+
+		case NodeArchetype::Lang_ForLoop:
+		{
+			// Same as ForLoopNode::process(), with the loop state kept in locals
+			const std::string& i = m_locals.at(&node.getOutputPortList()[0]).name;
+			const std::string first = operand(step, 0, "int");
+			const std::string last = operand(step, 1, "int");
+			m_body << std::format("\tif (!{0}_running)\n\t{{\n\t\t{0} = {1};\n\t\t{0}_running = ({1} <= {2});\n\t}}\n", i, first, last);
+			m_body << std::format("\telse\n\t{{\n\t\t{0}_running = ({0} < {1});\n\t\tif ({0}_running)\n\t\t\t{0}++;\n\t}}\n", i, last);
+			m_body << std::format("\tif ({}_running) goto {};\n", i, label(step.jump));
+			break;
+		}
+		default:
+			return make_unexpected(Error(std::format("Node '{}' can't be exported as native code", node.nodeName()), 137));
+		}
+
+		emitJump(index, step.next);
+		return {};
+	}
+
+	void NativeCodegen::emitJump(std::uint32_t from, std::int32_t target)
+	{
+		const auto fallthrough = (target == -1) ? static_cast<std::int32_t>(m_plan.steps().size()) : target;
+		if (fallthrough != static_cast<std::int32_t>(from + 1))
+			m_body << std::format("\tgoto {};\n", label(target));
+	}
+
+	std::string NativeCodegen::operand(const ExecutionStep& step, std::uint32_t index, const std::string& type)
+	{
+		const OutputPortHandle* source = m_plan.inputSource(step.firstInput + index);
+		if (source == nullptr)
+			return std::format("{}{{}}", type);
+
+		if (auto local = m_locals.find(source); local != m_locals.end())
+			return local->second.name;
+
+		return std::format("(*static_cast<const {}*>(ports[{}]))", type, portIndex(*source));
+	}
+
+	size_t NativeCodegen::portIndex(const OutputPortHandle& port)
+	{
+		auto [it, inserted] = m_portIndex.try_emplace(&port, m_source.ports.size());
+		if (inserted)
+			m_source.ports.push_back(&port);
+		return it->second;
+	}
+
+	std::string NativeCodegen::label(std::int32_t step) const
+	{
+		return (step == -1) ? "end" : std::format("s{}", step);
+	}
+
+	void NativeCodegen::makeSignature()
+	{
+		// Scheduled nodes and the ports they read, in step order
+		for (const auto& step : m_plan.steps())
+		{
+			m_source.signature += std::format("{}(", static_cast<std::uint64_t>(step.node->uuid()));
+			for (const auto& iPort : step.node->getInputPortList())
+			{
+				const PortLink link = iPort.link();
+				if (link.valid())
+					m_source.signature += std::format("{}.{},", static_cast<std::uint64_t>(link.targetNode->uuid()), link.targetIndex);
+			}
+			m_source.signature += ");";
+		}
+	}
+}
@@ -0,0 +1,123 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+#include <string>
+#include <vector>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <unordered_map>
+
+#include "typedefs.hpp"
+#include "core/Error.hpp"
+#include "utility/Expected.hpp"
+#include "script/ExecutionPlan.hpp"
+
+namespace nf
+{
+	/**
+	 * @brief Function exported by a script compiled to native code.
+	 * 'ports' holds the value pointer of each port in NativeSource::ports order.
+	*/
+	using NativeEntry = void(*)(void* const* ports);
+
+	/**
+	 * @brief Self-contained C++ translation unit generated from a built ExecutionPlan
+	*/
+	struct NativeSource
+	{
+		std::string code;
+		std::string signature;							// Identifies the plan the code was generated from
+		std::vector<const OutputPortHandle*> ports;		// Port values read or written by the code
+		std::vector<std::pair<Node*, PortIndex>> written;	// Outputs assigned by the code
+	};
+
+	/**
+	 * @brief Translates an ExecutionPlan into C++ code calling the registered functions directly.
+	 * Values computed within the plan live in local variables and are written back to their ports once the
+	 * execution finished. Values computed outside (variables, folded nodes) are read from their ports.
+	 * Steps become labels and the jumps of branches and loops become gotos.
+	 * Supports FunctorNodes whose function was declared via FlowModule::nativizeFunction(), IfElse and loop nodes.
+	*/
+	class NativeCodegen
+	{
+	public:
+		static constexpr auto entryPoint = "nf_native_run";
+		static constexpr auto signatureSymbol = "nf_native_signature";
+
+	public:
+		/**
+		 * @return the generated source or an Error if a scheduled node can't be exported
+		*/
+		static Expected<NativeSource, Error> generate(const ExecutionPlan& plan);
+
+	private:
+		explicit NativeCodegen(const ExecutionPlan& plan);
+
+		Expected<void, Error> declareLocals();
+
+		Expected<void, Error> emitStep(std::uint32_t index);
+
+		void emitJump(std::uint32_t from, std::int32_t target);
+
+		/**
+		 * @brief Returns the expression reading input 'index' of a step. 'type' names its type if read from a port.
+		*/
+		std::string operand(const ExecutionStep& step, std::uint32_t index, const std::string& type);
+
+		size_t portIndex(const OutputPortHandle& port);
+
+		std::string label(std::int32_t step) const;
+
+		void makeSignature();
+
+	private:
+		struct Local
+		{
+			std::string name;
+			std::string type;
+			Node* node = nullptr;
+			PortIndex index = 0;
+		};
+
+		const ExecutionPlan& m_plan;
+		NativeSource m_source;
+		std::unordered_map<const OutputPortHandle*, Local> m_locals;	// Values computed by the plan
+		std::vector<const OutputPortHandle*> m_localOrder;
+		std::unordered_map<const OutputPortHandle*, size_t> m_portIndex;
+		std::set<std::string> m_headers;
+		std::vector<std::uint8_t> m_targets;	// Steps entered by a jump
+		std::ostringstream m_body;
+	};
+}
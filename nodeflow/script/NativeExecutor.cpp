@@ -0,0 +1,89 @@
+#include "script/NativeExecutor.hpp"
+#include "core/Node.hpp"
+
+#include <format>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace nf
+{
+	namespace
+	{
+		void* openLibrary(const std::string& path)
+		{
+#if defined(_WIN32)
+			return static_cast<void*>(LoadLibraryA(path.c_str()));
+#else
+			return dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+		}
+
+		void* findSymbol(void* library, const char* name)
+		{
+#if defined(_WIN32)
+			return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(library), name));
+#else
+			return dlsym(library, name);
+#endif
+		}
+
+		void closeLibrary(void* library)
+		{
+#if defined(_WIN32)
+			FreeLibrary(static_cast<HMODULE>(library));
+#else
+			dlclose(library);
+#endif
+		}
+	}
+
+	Expected<std::unique_ptr<NativeExecutor>, Error> NativeExecutor::load(const std::string& libraryPath, const ExecutionPlan& plan)
+	{
+		// The library only contains code, the ports it accesses are resolved from the plan again
+		auto source = NativeCodegen::generate(plan);
+		if (!source)
+			return make_unexpected(source.error());
+
+		void* library = openLibrary(libraryPath);
+		if (library == nullptr)
+			return make_unexpected(Error(std::format("Failed to load native script '{}'", libraryPath), 137));
+
+		std::unique_ptr<NativeExecutor> executor(new NativeExecutor(library));
+		auto signature = static_cast<const char*>(findSymbol(library, NativeCodegen::signatureSymbol));
+		executor->m_entry = reinterpret_cast<NativeEntry>(findSymbol(library, NativeCodegen::entryPoint));
+		if (signature == nullptr || executor->m_entry == nullptr)
+			return make_unexpected(Error(std::format("'{}' is not a native script", libraryPath), 137));
+
+		if (std::strcmp(signature, source->signature.c_str()) != 0)
+			return make_unexpected(Error(std::format("Native script '{}' was generated from a different build", libraryPath), 137));
+
+		for (const OutputPortHandle* port : source->ports)
+			executor->m_ports.push_back(const_cast<void*>(port->dataHandle().data()));
+		executor->m_written = std::move(source->written);
+		return executor;
+	}
+
+	NativeExecutor::NativeExecutor(void* library)
+		: m_library(library)
+	{}
+
+	NativeExecutor::~NativeExecutor()
+	{
+		closeLibrary(m_library);
+	}
+
+	void NativeExecutor::run() const
+	{
+		m_entry(m_ports.data());
+
+		for (const auto& [node, index] : m_written)
+			node->markOutputChanged(index);
+	}
+}
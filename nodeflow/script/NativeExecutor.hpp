@@ -0,0 +1,79 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+
+#include "typedefs.hpp"
+#include "core/Error.hpp"
+#include "utility/Expected.hpp"
+#include "script/NativeCodegen.hpp"
+
+namespace nf
+{
+	/**
+	 * @brief Executes a script through a shared library compiled from the output of NativeCodegen.
+	 * Bound to the ports of the ExecutionPlan it was loaded for, so it must be discarded once the plan changes.
+	*/
+	class NativeExecutor
+	{
+	public:
+		/**
+		 * @brief Loads the library at 'libraryPath' and binds it to the ports of 'plan'.
+		 * @return the executor or an Error if the library can't be loaded or was generated from a different plan
+		*/
+		static Expected<std::unique_ptr<NativeExecutor>, Error> load(const std::string& libraryPath, const ExecutionPlan& plan);
+
+		~NativeExecutor();
+
+		NativeExecutor(const NativeExecutor&) = delete;
+		NativeExecutor& operator=(const NativeExecutor&) = delete;
+
+		/**
+		 * @brief Executes the compiled script once. Outputs computed by it are marked as changed afterwards.
+		*/
+		void run() const;
+
+	private:
+		explicit NativeExecutor(void* library);
+
+	private:
+		void* m_library = nullptr;
+		NativeEntry m_entry = nullptr;
+		std::vector<void*> m_ports;
+		std::vector<std::pair<Node*, PortIndex>> m_written;
+	};
+}
@@ -0,0 +1,168 @@
+#include "script/ParallelScheduler.hpp"
+#include "core/Node.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace nf
+{
+	namespace
+	{
+		constexpr std::uint32_t NoStep = ~std::uint32_t(0);
+	}
+
+	void ParallelScheduler::compile(const ExecutionPlan& plan)
+	{
+		clear();
+
+		const auto& steps = plan.steps();
+		const auto stepCount = static_cast<std::uint32_t>(steps.size());
+
+		std::vector<std::vector<std::uint32_t>> predecessors(stepCount);
+		std::unordered_map<const Node*, std::uint32_t> lastWrite;
+		std::unordered_map<const Node*, std::vector<std::uint32_t>> readersSinceWrite;
+		std::uint32_t barrier = NoStep;
+		std::vector<std::uint32_t> sinceBarrier;
+
+		for (std::uint32_t j = 0; j < stepCount; j++)
+		{
+			const Node* node = steps[j].node;
+			auto& preds = predecessors[j];
+			const bool reorderable = isReorderable(*node);
+
+			// Barriers wait for everything before them. Everything after waits for the barrier.
+			if (!reorderable)
+				preds = sinceBarrier;
+			if (barrier != NoStep)
+				preds.push_back(barrier);
+
+			// Read after write
+			for (const PortLink& link : node->inputLinks())
+			{
+				if (!link.valid())
+					continue;
+
+				if (auto found = lastWrite.find(link.targetNode); found != lastWrite.end())
+					preds.push_back(found->second);
+				readersSinceWrite[link.targetNode].push_back(j);
+			}
+
+			// Write after write and write after read of the outputs of this node
+			if (auto found = lastWrite.find(node); found != lastWrite.end())
+				preds.push_back(found->second);
+			if (auto found = readersSinceWrite.find(node); found != readersSinceWrite.end())
+			{
+				preds.insert(preds.end(), found->second.begin(), found->second.end());
+				found->second.clear();
+			}
+			lastWrite[node] = j;
+
+			if (reorderable)
+				sinceBarrier.push_back(j);
+			else
+			{
+				barrier = j;
+				sinceBarrier.clear();
+			}
+
+			std::sort(preds.begin(), preds.end());
+			preds.erase(std::unique(preds.begin(), preds.end()), preds.end());
+			std::erase(preds, j);
+		}
+
+		// Flatten into successor lists
+		m_predecessorCounts.assign(stepCount, 0);
+		m_successorOffsets.assign(stepCount + 1, 0);
+		for (std::uint32_t j = 0; j < stepCount; j++)
+		{
+			m_predecessorCounts[j] = static_cast<std::uint32_t>(predecessors[j].size());
+			for (auto pred : predecessors[j])
+				m_successorOffsets[pred + 1]++;
+
+			if (predecessors[j].empty())
+				m_roots.push_back(j);
+		}
+
+		for (std::uint32_t i = 0; i < stepCount; i++)
+			m_successorOffsets[i + 1] += m_successorOffsets[i];
+
+		m_successors.resize(m_successorOffsets[stepCount]);
+		std::vector<std::uint32_t> fill(m_successorOffsets.begin(), m_successorOffsets.end() - 1);
+		for (std::uint32_t j = 0; j < stepCount; j++)
+		{
+			for (auto pred : predecessors[j])
+				m_successors[fill[pred]++] = j;
+		}
+
+		m_pending = std::make_unique<std::atomic<std::uint32_t>[]>(stepCount);
+		m_plan = &plan;
+	}
+
+	void ParallelScheduler::clear()
+	{
+		m_plan = nullptr;
+		m_successorOffsets.clear();
+		m_successors.clear();
+		m_predecessorCounts.clear();
+		m_roots.clear();
+		m_pending.reset();
+	}
+
+	void ParallelScheduler::run(ThreadPool& pool)
+	{
+		NF_ASSERT(compiled(), "ParallelScheduler has not been compiled");
+
+		const auto stepCount = static_cast<std::uint32_t>(m_predecessorCounts.size());
+		if (stepCount == 0)
+			return;
+
+		for (std::uint32_t i = 0; i < stepCount; i++)
+			m_pending[i].store(m_predecessorCounts[i], std::memory_order_relaxed);
+
+		m_pool = &pool;
+		m_remaining.store(stepCount, std::memory_order_release);
+
+		for (auto root : m_roots)
+			pool.submit({ &ParallelScheduler::executeStep, this, root });
+
+		for (auto remaining = m_remaining.load(std::memory_order_acquire); remaining != 0;
+			 remaining = m_remaining.load(std::memory_order_acquire))
+			m_remaining.wait(remaining, std::memory_order_acquire);
+	}
+
+	void ParallelScheduler::executeStep(void* context, std::uint32_t index)
+	{
+		auto& self = *static_cast<ParallelScheduler*>(context);
+
+		auto current = index;
+		while (current != NoStep)
+		{
+			self.m_plan->execute(current);
+
+			// The first successor that becomes ready is executed on this thread right away
+			auto next = NoStep;
+			for (auto i = self.m_successorOffsets[current]; i < self.m_successorOffsets[current + 1]; i++)
+			{
+				auto successor = self.m_successors[i];
+				if (self.m_pending[successor].fetch_sub(1, std::memory_order_acq_rel) != 1)
+					continue;
+
+				if (next == NoStep)
+					next = successor;
+				else
+					self.m_pool->submit({ &ParallelScheduler::executeStep, &self, successor });
+			}
+
+			if (self.m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				self.m_remaining.notify_all();
+
+			current = next;
+		}
+	}
+
+	bool ParallelScheduler::isReorderable(const Node& node)
+	{
+		auto archetype = node.getArchetype();
+		return archetype == NodeArchetype::Flow_FunctorNode || archetype == NodeArchetype::Flow_ConversionNode;
+	}
+}
@@ -0,0 +1,93 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+#include "typedefs.hpp"
+#include "script/ExecutionPlan.hpp"
+#include "utility/ThreadPool.hpp"
+
+namespace nf
+{
+	/**
+	 * @brief Executes the steps of a linear ExecutionPlan concurrently on a ThreadPool.
+	 * Dependencies between steps are derived from their data links. Only FunctorNodes and ConversionNodes
+	 * are reordered. Every other node acts as barrier, so flow order and side effects stay intact.
+	*/
+	class ParallelScheduler
+	{
+	public:
+		ParallelScheduler() = default;
+
+		ParallelScheduler(const ParallelScheduler&) = delete;
+		ParallelScheduler& operator=(const ParallelScheduler&) = delete;
+
+		/**
+		 * @brief Builds the dependency graph of all steps in 'plan'. The plan must outlive the scheduler.
+		*/
+		void compile(const ExecutionPlan& plan);
+
+		void clear();
+
+		/**
+		 * @brief Executes all steps once. Blocks until every step has finished.
+		*/
+		void run(ThreadPool& pool);
+
+		inline bool compiled() const noexcept { return m_plan != nullptr; }
+
+		/**
+		 * @brief Returns the steps without any dependency, which are dispatched first
+		*/
+		inline const std::vector<std::uint32_t>& roots() const noexcept { return m_roots; }
+
+	private:
+		static void executeStep(void* context, std::uint32_t index);
+
+		static bool isReorderable(const Node& node);
+
+	private:
+		const ExecutionPlan* m_plan = nullptr;
+		std::vector<std::uint32_t> m_successorOffsets;
+		std::vector<std::uint32_t> m_successors;
+		std::vector<std::uint32_t> m_predecessorCounts;
+		std::vector<std::uint32_t> m_roots;
+		std::unique_ptr<std::atomic<std::uint32_t>[]> m_pending;
+		std::atomic<std::uint32_t> m_remaining{ 0 };
+		ThreadPool* m_pool = nullptr;
+	};
+}
@@ -0,0 +1,141 @@
+#include "script/Profiler.hpp"
+#include "core/Node.hpp"
+#include "3rdparty/nlohmann/json.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace nf
+{
+	namespace
+	{
+		std::atomic<std::uint64_t> nextProfilerID{ 1 };
+
+		// Buffer of the profiler the current thread recorded into last. Avoids locking on every event.
+		struct BufferCache
+		{
+			std::uint64_t profilerID = 0;
+			void* buffer = nullptr;
+		};
+		thread_local BufferCache bufferCache;
+
+		std::int64_t nanoseconds(Profiler::Clock::duration duration)
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+		}
+	}
+
+	Profiler::Profiler(size_t eventsPerThread /*= 1 << 16*/)
+		: m_id(nextProfilerID.fetch_add(1)), m_capacity(std::max<size_t>(eventsPerThread, 1)), m_start(Clock::now())
+	{
+	}
+
+	Profiler::~Profiler() = default;
+
+	void Profiler::record(const Node* node, Clock::time_point begin, Clock::time_point end)
+	{
+		ThreadBuffer& buffer = threadBuffer();
+		const size_t index = buffer.written.load(std::memory_order_relaxed);
+		buffer.events[index % m_capacity] = Event{ node->nodeName(), node->uuid(), nanoseconds(begin - m_start), nanoseconds(end - m_start) };
+		buffer.written.store(index + 1, std::memory_order_release);
+	}
+
+	Profiler::ThreadBuffer& Profiler::threadBuffer()
+	{
+		if (bufferCache.profilerID == m_id)
+			return *static_cast<ThreadBuffer*>(bufferCache.buffer);
+
+		std::lock_guard lock(m_mutex);
+		const auto threadID = std::this_thread::get_id();
+		auto found = std::find_if(m_buffers.begin(), m_buffers.end(), [threadID](const auto& buffer) { return buffer->thread == threadID; });
+		if (found == m_buffers.end())
+		{
+			auto buffer = std::make_unique<ThreadBuffer>();
+			buffer->events.resize(m_capacity);
+			buffer->thread = threadID;
+			buffer->threadIndex = m_buffers.size();
+			found = m_buffers.insert(m_buffers.end(), std::move(buffer));
+		}
+
+		bufferCache = BufferCache{ m_id, found->get() };
+		return **found;
+	}
+
+	template<class Callable>
+	void Profiler::forEachEvent(Callable callable) const
+	{
+		std::lock_guard lock(m_mutex);
+		for (const auto& buffer : m_buffers)
+		{
+			const size_t written = buffer->written.load(std::memory_order_acquire);
+			const size_t count = std::min(written, m_capacity);
+			for (size_t i = written - count; i < written; i++)
+				callable(buffer->events[i % m_capacity], buffer->threadIndex);
+		}
+	}
+
+	std::vector<Profiler::NodeStatistics> Profiler::statistics() const
+	{
+		struct Durations
+		{
+			std::string_view name;
+			std::vector<std::int64_t> values;
+		};
+
+		std::unordered_map<UUID, Durations> durations;
+		forEachEvent([&durations](const Event& event, size_t) {
+			Durations& entry = durations[event.uuid];
+			entry.name = event.name;
+			entry.values.push_back(event.end - event.begin);
+		});
+
+		std::vector<NodeStatistics> statistics;
+		for (auto& [uuid, recorded] : durations)
+		{
+			auto& nodeDurations = recorded.values;
+			std::sort(nodeDurations.begin(), nodeDurations.end());
+			auto percentile = [&nodeDurations](size_t p) { return nodeDurations[(nodeDurations.size() - 1) * p / 100]; };
+
+			NodeStatistics entry;
+			entry.name = recorded.name;
+			entry.uuid = uuid;
+			entry.calls = nodeDurations.size();
+			for (auto duration : nodeDurations)
+				entry.total += duration;
+			entry.p50 = percentile(50);
+			entry.p99 = percentile(99);
+			statistics.push_back(entry);
+		}
+
+		std::sort(statistics.begin(), statistics.end(), [](const NodeStatistics& a, const NodeStatistics& b) { return a.total > b.total; });
+		return statistics;
+	}
+
+	std::string Profiler::chromeTrace() const
+	{
+		// Complete events ('X'), timestamps and durations in microseconds
+		nlohmann::json events = nlohmann::json::array();
+		forEachEvent([&events](const Event& event, size_t threadIndex) {
+			events.push_back({
+				{ "name", std::string(event.name) },
+				{ "cat", "node" },
+				{ "ph", "X" },
+				{ "ts", static_cast<double>(event.begin) / 1000.0 },
+				{ "dur", static_cast<double>(event.end - event.begin) / 1000.0 },
+				{ "pid", 0 },
+				{ "tid", threadIndex },
+				{ "args", { { "uuid", static_cast<std::uint64_t>(event.uuid) } } }
+			});
+		});
+
+		nlohmann::json trace = { { "traceEvents", std::move(events) }, { "displayTimeUnit", "ns" } };
+		return trace.dump();
+	}
+
+	void Profiler::clear()
+	{
+		std::lock_guard lock(m_mutex);
+		for (auto& buffer : m_buffers)
+			buffer->written.store(0, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,137 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <string_view>
+
+#include "typedefs.hpp"
+#include "core/UUID.hpp"
+
+namespace nf
+{
+	class Node;
+
+	/**
+	 * @brief Records the duration of every node executed by an ExecutionPlan (see FlowScript::setProfiler()).
+	 * Each thread writes into its own ring buffer without locking, the oldest events are overwritten once it is full.
+	 * Events store the name and UUID of their node, so they can be exported after the node was destroyed.
+	 * Exporting or clearing must not overlap with a profiled execution.
+	*/
+	class Profiler
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		struct Event
+		{
+			std::string_view name;	// See Node::nodeName(), the text outlives the node
+			UUID uuid{ 0 };
+			std::int64_t begin = 0;	// Nanoseconds since the profiler was created
+			std::int64_t end = 0;
+		};
+
+		/**
+		 * @brief Aggregated durations of a single node, in nanoseconds
+		*/
+		struct NodeStatistics
+		{
+			std::string_view name;
+			UUID uuid{ 0 };
+			size_t calls = 0;
+			std::int64_t total = 0;
+			std::int64_t p50 = 0;
+			std::int64_t p99 = 0;
+		};
+
+	public:
+		/**
+		 * @param eventsPerThread capacity of the ring buffer of each thread
+		*/
+		explicit Profiler(size_t eventsPerThread = 1 << 16);
+		~Profiler();
+
+		Profiler(const Profiler&) = delete;
+		Profiler& operator=(const Profiler&) = delete;
+
+		inline static Clock::time_point now() noexcept { return Clock::now(); }
+
+		void record(const Node* node, Clock::time_point begin, Clock::time_point end);
+
+		/**
+		 * @brief Returns the statistics of every recorded node, grouped by UUID, the most expensive first
+		*/
+		std::vector<NodeStatistics> statistics() const;
+
+		/**
+		 * @brief Returns all events as Chrome trace event JSON, which can be opened in chrome://tracing or Perfetto
+		*/
+		std::string chromeTrace() const;
+
+		/**
+		 * @brief Discards all recorded events
+		*/
+		void clear();
+
+	private:
+		struct ThreadBuffer
+		{
+			std::vector<Event> events;
+			std::atomic<size_t> written{ 0 };	// Total number of events, the ring holds the last events.size()
+			std::thread::id thread;
+			size_t threadIndex = 0;
+		};
+
+		ThreadBuffer& threadBuffer();
+
+		/**
+		 * @brief Calls 'callable' for every event still held by the ring buffers
+		*/
+		template<class Callable>
+		void forEachEvent(Callable callable) const;
+
+	private:
+		const std::uint64_t m_id;	// Identifies the profiler within the buffer cache of each thread
+		const size_t m_capacity;
+		const Clock::time_point m_start;
+		mutable std::mutex m_mutex;	// Only guards the registration of new threads
+		std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+	};
+}
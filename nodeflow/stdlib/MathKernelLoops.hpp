@@ -0,0 +1,139 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+#include <cstddef>
+
+#include "stdlib/MathKernels.hpp"
+
+namespace nf::math::detail
+{
+	/**
+	 * @brief Column loops shared by the instruction set specific kernels.
+	 * 'V' wraps the intrinsics of one register type: scalar_t, reg_t, width, load, store, add, sub, mul, fma, min and max.
+	 * V::min(a, b) and V::max(a, b) must match std::min and std::max, including the operand returned for NaN.
+	 * V::fma(a, b, c) must round the product before adding, like the scalar tails, so a result doesn't depend
+	 * on the position of the value in the column or on the CPU.
+	 * The tails compute in kernel_arithmetic_t<T>, so integers wrap around like the SIMD lanes.
+	 * Only include from translation units compiled for V's instruction set, and keep the standard library out of
+	 * them, as inline functions instantiated there could be merged with the ones of other translation units.
+	*/
+	template<class V>
+	struct SimdLoops
+	{
+		using T = typename V::scalar_t;
+		using U = kernel_arithmetic_t<T>;
+		static constexpr size_t W = V::width;
+
+		static void add(T* out, const T* a, const T* b, size_t count)
+		{
+			size_t i = 0;
+			for (; i + W <= count; i += W)
+				V::store(out + i, V::add(V::load(a + i), V::load(b + i)));
+			for (; i < count; i++)
+				out[i] = static_cast<T>(static_cast<U>(a[i]) + static_cast<U>(b[i]));
+		}
+
+		static void mul(T* out, const T* a, const T* b, size_t count)
+		{
+			size_t i = 0;
+			for (; i + W <= count; i += W)
+				V::store(out + i, V::mul(V::load(a + i), V::load(b + i)));
+			for (; i < count; i++)
+				out[i] = static_cast<T>(static_cast<U>(a[i]) * static_cast<U>(b[i]));
+		}
+
+		static void fma(T* out, const T* a, const T* b, const T* c, size_t count)
+		{
+			size_t i = 0;
+			for (; i + W <= count; i += W)
+				V::store(out + i, V::fma(V::load(a + i), V::load(b + i), V::load(c + i)));
+			for (; i < count; i++)
+				out[i] = static_cast<T>(static_cast<U>(a[i]) * static_cast<U>(b[i]) + static_cast<U>(c[i]));
+		}
+
+		static void min(T* out, const T* a, const T* b, size_t count)
+		{
+			size_t i = 0;
+			for (; i + W <= count; i += W)
+				V::store(out + i, V::min(V::load(a + i), V::load(b + i)));
+			for (; i < count; i++)
+				out[i] = (b[i] < a[i]) ? b[i] : a[i];
+		}
+
+		static void max(T* out, const T* a, const T* b, size_t count)
+		{
+			size_t i = 0;
+			for (; i + W <= count; i += W)
+				V::store(out + i, V::max(V::load(a + i), V::load(b + i)));
+			for (; i < count; i++)
+				out[i] = (a[i] < b[i]) ? b[i] : a[i];
+		}
+
+		static void clamp(T* out, const T* x, const T* lo, const T* hi, size_t count)
+		{
+			size_t i = 0;
+			for (; i + W <= count; i += W)
+				V::store(out + i, V::min(V::max(V::load(x + i), V::load(lo + i)), V::load(hi + i)));
+			for (; i < count; i++)
+			{
+				const T low = (x[i] < lo[i]) ? lo[i] : x[i];
+				out[i] = (hi[i] < low) ? hi[i] : low;
+			}
+		}
+
+		static void lerp(T* out, const T* a, const T* b, const T* t, size_t count)
+		{
+			size_t i = 0;
+			for (; i + W <= count; i += W)
+			{
+				const auto va = V::load(a + i);
+				V::store(out + i, V::fma(V::sub(V::load(b + i), va), V::load(t + i), va));
+			}
+			for (; i < count; i++)
+				out[i] = static_cast<T>(static_cast<U>(a[i]) + (static_cast<U>(b[i]) - static_cast<U>(a[i])) * static_cast<U>(t[i]));
+		}
+
+		static void fill(MathKernelTable<T>& table)
+		{
+			table.add = &SimdLoops::add;
+			table.mul = &SimdLoops::mul;
+			table.fma = &SimdLoops::fma;
+			table.min = &SimdLoops::min;
+			table.max = &SimdLoops::max;
+			table.clamp = &SimdLoops::clamp;
+			table.lerp = &SimdLoops::lerp;
+		}
+	};
+}
@@ -0,0 +1,222 @@
+#include "stdlib/MathKernels.hpp"
+
+#include <atomic>
+#include <algorithm>
+
+#if NF_MATH_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace nf::math
+{
+	namespace
+	{
+		#pragma region Scalar kernels
+		template<typename T>
+		void addScalar(T* out, const T* a, const T* b, size_t count)
+		{
+			using U = detail::kernel_arithmetic_t<T>;
+			for (size_t i = 0; i < count; i++)
+				out[i] = static_cast<T>(static_cast<U>(a[i]) + static_cast<U>(b[i]));
+		}
+
+		template<typename T>
+		void mulScalar(T* out, const T* a, const T* b, size_t count)
+		{
+			using U = detail::kernel_arithmetic_t<T>;
+			for (size_t i = 0; i < count; i++)
+				out[i] = static_cast<T>(static_cast<U>(a[i]) * static_cast<U>(b[i]));
+		}
+
+		template<typename T>
+		void fmaScalar(T* out, const T* a, const T* b, const T* c, size_t count)
+		{
+			using U = detail::kernel_arithmetic_t<T>;
+			for (size_t i = 0; i < count; i++)
+				out[i] = static_cast<T>(static_cast<U>(a[i]) * static_cast<U>(b[i]) + static_cast<U>(c[i]));
+		}
+
+		template<typename T>
+		void minScalar(T* out, const T* a, const T* b, size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+				out[i] = std::min(a[i], b[i]);
+		}
+
+		template<typename T>
+		void maxScalar(T* out, const T* a, const T* b, size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+				out[i] = std::max(a[i], b[i]);
+		}
+
+		template<typename T>
+		void clampScalar(T* out, const T* x, const T* lo, const T* hi, size_t count)
+		{
+			for (size_t i = 0; i < count; i++)
+				out[i] = std::min(std::max(x[i], lo[i]), hi[i]);
+		}
+
+		template<typename T>
+		void lerpScalar(T* out, const T* a, const T* b, const T* t, size_t count)
+		{
+			using U = detail::kernel_arithmetic_t<T>;
+			for (size_t i = 0; i < count; i++)
+				out[i] = static_cast<T>(static_cast<U>(a[i]) + (static_cast<U>(b[i]) - static_cast<U>(a[i])) * static_cast<U>(t[i]));
+		}
+
+		template<typename T>
+		MathKernelTable<T> makeScalarTable()
+		{
+			MathKernelTable<T> table;
+			table.add = &addScalar<T>;
+			table.mul = &mulScalar<T>;
+			table.fma = &fmaScalar<T>;
+			table.min = &minScalar<T>;
+			table.max = &maxScalar<T>;
+			table.clamp = &clampScalar<T>;
+			table.lerp = &lerpScalar<T>;
+			return table;
+		}
+		#pragma endregion
+
+		template<typename T>
+		struct LevelTables
+		{
+			MathKernelTable<T> tables[3];
+		};
+
+		struct KernelRegistry
+		{
+			LevelTables<float> f;
+			LevelTables<double> d;
+			LevelTables<std::int32_t> i;
+			SimdLevel supported = SimdLevel::Scalar;
+			std::atomic<SimdLevel> active{ SimdLevel::Scalar };
+
+			KernelRegistry()
+			{
+				supported = detectSimdLevel();
+
+				// Each level starts from the previous one, so operations without a dedicated kernel fall back
+				f.tables[0] = makeScalarTable<float>();
+				d.tables[0] = makeScalarTable<double>();
+				i.tables[0] = makeScalarTable<std::int32_t>();
+
+				f.tables[1] = f.tables[0];
+				d.tables[1] = d.tables[0];
+				i.tables[1] = i.tables[0];
+				if (supported >= SimdLevel::SSE41)
+					detail::fillKernelsSSE41(f.tables[1], d.tables[1], i.tables[1]);
+
+				f.tables[2] = f.tables[1];
+				d.tables[2] = d.tables[1];
+				i.tables[2] = i.tables[1];
+				if (supported >= SimdLevel::AVX2)
+					detail::fillKernelsAVX2(f.tables[2], d.tables[2], i.tables[2]);
+
+				active.store(supported, std::memory_order_relaxed);
+			}
+		};
+
+		KernelRegistry& registry()
+		{
+			static KernelRegistry instance;
+			return instance;
+		}
+	}
+
+	SimdLevel detectSimdLevel()
+	{
+	#if NF_MATH_X86
+		unsigned int regs[4] = {};
+		auto cpuid = [&regs](unsigned int leaf, unsigned int subleaf) {
+		#ifdef _MSC_VER
+			__cpuidex(reinterpret_cast<int*>(regs), static_cast<int>(leaf), static_cast<int>(subleaf));
+		#else
+			__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+		#endif
+		};
+
+		cpuid(0, 0);
+		const unsigned int maxLeaf = regs[0];
+		if (maxLeaf < 1)
+			return SimdLevel::Scalar;
+
+		cpuid(1, 0);
+		const bool sse41 = (regs[2] & (1u << 19)) != 0;
+		const bool fma = (regs[2] & (1u << 12)) != 0;
+		const bool osxsave = (regs[2] & (1u << 27)) != 0;
+		const bool avx = (regs[2] & (1u << 28)) != 0;
+		if (!sse41)
+			return SimdLevel::Scalar;
+
+		// The OS must save the upper halves of the ymm registers on context switches
+		bool ymmEnabled = false;
+		if (osxsave && avx)
+		{
+		#ifdef _MSC_VER
+			const unsigned long long xcr0 = _xgetbv(0);
+		#else
+			unsigned int eax = 0, edx = 0;
+			__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+			const unsigned long long xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+		#endif
+			ymmEnabled = (xcr0 & 0x6) == 0x6;
+		}
+
+		bool avx2 = false;
+		if (maxLeaf >= 7)
+		{
+			cpuid(7, 0);
+			avx2 = (regs[1] & (1u << 5)) != 0;
+		}
+
+		if (ymmEnabled && avx2 && fma)
+			return SimdLevel::AVX2;
+		return SimdLevel::SSE41;
+	#else
+		return SimdLevel::Scalar;
+	#endif
+	}
+
+	SimdLevel simdLevel()
+	{
+		return registry().active.load(std::memory_order_relaxed);
+	}
+
+	bool setSimdLevel(SimdLevel level)
+	{
+		auto& reg = registry();
+		if (level > reg.supported)
+			return false;
+
+		reg.active.store(level, std::memory_order_relaxed);
+		return true;
+	}
+
+	template<>
+	const MathKernelTable<float>& mathKernels<float>()
+	{
+		auto& reg = registry();
+		return reg.f.tables[static_cast<int>(reg.active.load(std::memory_order_relaxed))];
+	}
+
+	template<>
+	const MathKernelTable<double>& mathKernels<double>()
+	{
+		auto& reg = registry();
+		return reg.d.tables[static_cast<int>(reg.active.load(std::memory_order_relaxed))];
+	}
+
+	template<>
+	const MathKernelTable<std::int32_t>& mathKernels<std::int32_t>()
+	{
+		auto& reg = registry();
+		return reg.i.tables[static_cast<int>(reg.active.load(std::memory_order_relaxed))];
+	}
+}
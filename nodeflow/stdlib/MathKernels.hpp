@@ -0,0 +1,115 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define NF_MATH_X86 1
+#else
+#define NF_MATH_X86 0
+#endif
+
+namespace nf::math
+{
+	/**
+	 * @brief Instruction set used by the column kernels of the standard math library
+	*/
+	enum class SimdLevel
+	{
+		Scalar,
+		SSE41,
+		AVX2	// Includes FMA3
+	};
+
+	/**
+	 * @brief Element-wise kernels over raw columns of 'count' values.
+	 * Output may alias any of the inputs.
+	*/
+	template<typename T>
+	struct MathKernelTable
+	{
+		void (*add)(T* out, const T* a, const T* b, size_t count) = nullptr;
+		void (*mul)(T* out, const T* a, const T* b, size_t count) = nullptr;
+		void (*fma)(T* out, const T* a, const T* b, const T* c, size_t count) = nullptr;	// a * b + c, rounded twice like the scalar math::fma()
+		void (*min)(T* out, const T* a, const T* b, size_t count) = nullptr;
+		void (*max)(T* out, const T* a, const T* b, size_t count) = nullptr;
+		void (*clamp)(T* out, const T* x, const T* lo, const T* hi, size_t count) = nullptr;
+		void (*lerp)(T* out, const T* a, const T* b, const T* t, size_t count) = nullptr;		// a + (b - a) * t
+	};
+
+	/**
+	 * @brief Returns the best instruction set supported by the CPU and the operating system
+	*/
+	SimdLevel detectSimdLevel();
+
+	/**
+	 * @brief Returns the instruction set currently used by mathKernels()
+	*/
+	SimdLevel simdLevel();
+
+	/**
+	 * @brief Restricts the kernels to an instruction set, ex. for benchmarking.
+	 * @return 'false' if the level is not supported by this CPU. The level is not changed then
+	*/
+	bool setSimdLevel(SimdLevel level);
+
+	/**
+	 * @brief Returns the kernels of the current SimdLevel. Defaults to detectSimdLevel().
+	 * Supported types are float, double and std::int32_t.
+	*/
+	template<typename T>
+	const MathKernelTable<T>& mathKernels();
+
+	namespace detail
+	{
+		/**
+		 * @brief Type the kernels compute values of type 'T' in. Signed integers are computed as unsigned,
+		 * so they wrap around like the SIMD lanes instead of overflowing.
+		*/
+		template<typename T>
+		struct KernelArithmetic { using type = T; };
+
+		template<>
+		struct KernelArithmetic<std::int32_t> { using type = std::uint32_t; };
+
+		template<typename T>
+		using kernel_arithmetic_t = typename KernelArithmetic<T>::type;
+
+		// Implemented by the instruction set specific translation units. Unsupported operations are left untouched.
+		void fillKernelsSSE41(MathKernelTable<float>& f, MathKernelTable<double>& d, MathKernelTable<std::int32_t>& i);
+		void fillKernelsAVX2(MathKernelTable<float>& f, MathKernelTable<double>& d, MathKernelTable<std::int32_t>& i);
+	}
+}
@@ -0,0 +1,91 @@
+#include "stdlib/MathKernels.hpp"
+
+#if NF_MATH_X86
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC target("avx2,fma")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include <immintrin.h>
+#include "stdlib/MathKernelLoops.hpp"
+
+namespace nf::math::detail
+{
+	namespace
+	{
+		// Operands of min/max are swapped to match std::min/std::max: (b < a) ? b : a
+		// fma() doesn't use the FMA instructions, which round once and would give other results than the scalar kernels
+
+		struct AvxFloat
+		{
+			using scalar_t = float;
+			using reg_t = __m256;
+			static constexpr size_t width = 8;
+
+			static reg_t load(const float* p) { return _mm256_loadu_ps(p); }
+			static void store(float* p, reg_t v) { _mm256_storeu_ps(p, v); }
+			static reg_t add(reg_t a, reg_t b) { return _mm256_add_ps(a, b); }
+			static reg_t sub(reg_t a, reg_t b) { return _mm256_sub_ps(a, b); }
+			static reg_t mul(reg_t a, reg_t b) { return _mm256_mul_ps(a, b); }
+			static reg_t fma(reg_t a, reg_t b, reg_t c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+			static reg_t min(reg_t a, reg_t b) { return _mm256_min_ps(b, a); }
+			static reg_t max(reg_t a, reg_t b) { return _mm256_max_ps(b, a); }
+		};
+
+		struct AvxDouble
+		{
+			using scalar_t = double;
+			using reg_t = __m256d;
+			static constexpr size_t width = 4;
+
+			static reg_t load(const double* p) { return _mm256_loadu_pd(p); }
+			static void store(double* p, reg_t v) { _mm256_storeu_pd(p, v); }
+			static reg_t add(reg_t a, reg_t b) { return _mm256_add_pd(a, b); }
+			static reg_t sub(reg_t a, reg_t b) { return _mm256_sub_pd(a, b); }
+			static reg_t mul(reg_t a, reg_t b) { return _mm256_mul_pd(a, b); }
+			static reg_t fma(reg_t a, reg_t b, reg_t c) { return _mm256_add_pd(_mm256_mul_pd(a, b), c); }
+			static reg_t min(reg_t a, reg_t b) { return _mm256_min_pd(b, a); }
+			static reg_t max(reg_t a, reg_t b) { return _mm256_max_pd(b, a); }
+		};
+
+		struct AvxInt32
+		{
+			using scalar_t = std::int32_t;
+			using reg_t = __m256i;
+			static constexpr size_t width = 8;
+
+			static reg_t load(const std::int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+			static void store(std::int32_t* p, reg_t v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+			static reg_t add(reg_t a, reg_t b) { return _mm256_add_epi32(a, b); }
+			static reg_t sub(reg_t a, reg_t b) { return _mm256_sub_epi32(a, b); }
+			static reg_t mul(reg_t a, reg_t b) { return _mm256_mullo_epi32(a, b); }
+			static reg_t fma(reg_t a, reg_t b, reg_t c) { return _mm256_add_epi32(_mm256_mullo_epi32(a, b), c); }
+			static reg_t min(reg_t a, reg_t b) { return _mm256_min_epi32(a, b); }
+			static reg_t max(reg_t a, reg_t b) { return _mm256_max_epi32(a, b); }
+		};
+	}
+
+	void fillKernelsAVX2(MathKernelTable<float>& f, MathKernelTable<double>& d, MathKernelTable<std::int32_t>& i)
+	{
+		SimdLoops<AvxFloat>::fill(f);
+		SimdLoops<AvxDouble>::fill(d);
+		SimdLoops<AvxInt32>::fill(i);
+	}
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#else
+
+namespace nf::math::detail
+{
+	void fillKernelsAVX2(MathKernelTable<float>&, MathKernelTable<double>&, MathKernelTable<std::int32_t>&) {}
+}
+
+#endif
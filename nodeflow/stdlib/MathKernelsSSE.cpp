@@ -0,0 +1,88 @@
+#include "stdlib/MathKernels.hpp"
+
+#if NF_MATH_X86
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse4.1"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("sse4.1")
+#endif
+
+#include <smmintrin.h>
+#include "stdlib/MathKernelLoops.hpp"
+
+namespace nf::math::detail
+{
+	namespace
+	{
+		// Operands of min/max are swapped to match std::min/std::max: (b < a) ? b : a
+
+		struct SseFloat
+		{
+			using scalar_t = float;
+			using reg_t = __m128;
+			static constexpr size_t width = 4;
+
+			static reg_t load(const float* p) { return _mm_loadu_ps(p); }
+			static void store(float* p, reg_t v) { _mm_storeu_ps(p, v); }
+			static reg_t add(reg_t a, reg_t b) { return _mm_add_ps(a, b); }
+			static reg_t sub(reg_t a, reg_t b) { return _mm_sub_ps(a, b); }
+			static reg_t mul(reg_t a, reg_t b) { return _mm_mul_ps(a, b); }
+			static reg_t fma(reg_t a, reg_t b, reg_t c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+			static reg_t min(reg_t a, reg_t b) { return _mm_min_ps(b, a); }
+			static reg_t max(reg_t a, reg_t b) { return _mm_max_ps(b, a); }
+		};
+
+		struct SseDouble
+		{
+			using scalar_t = double;
+			using reg_t = __m128d;
+			static constexpr size_t width = 2;
+
+			static reg_t load(const double* p) { return _mm_loadu_pd(p); }
+			static void store(double* p, reg_t v) { _mm_storeu_pd(p, v); }
+			static reg_t add(reg_t a, reg_t b) { return _mm_add_pd(a, b); }
+			static reg_t sub(reg_t a, reg_t b) { return _mm_sub_pd(a, b); }
+			static reg_t mul(reg_t a, reg_t b) { return _mm_mul_pd(a, b); }
+			static reg_t fma(reg_t a, reg_t b, reg_t c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+			static reg_t min(reg_t a, reg_t b) { return _mm_min_pd(b, a); }
+			static reg_t max(reg_t a, reg_t b) { return _mm_max_pd(b, a); }
+		};
+
+		struct SseInt32
+		{
+			using scalar_t = std::int32_t;
+			using reg_t = __m128i;
+			static constexpr size_t width = 4;
+
+			static reg_t load(const std::int32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+			static void store(std::int32_t* p, reg_t v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+			static reg_t add(reg_t a, reg_t b) { return _mm_add_epi32(a, b); }
+			static reg_t sub(reg_t a, reg_t b) { return _mm_sub_epi32(a, b); }
+			static reg_t mul(reg_t a, reg_t b) { return _mm_mullo_epi32(a, b); }
+			static reg_t fma(reg_t a, reg_t b, reg_t c) { return _mm_add_epi32(_mm_mullo_epi32(a, b), c); }
+			static reg_t min(reg_t a, reg_t b) { return _mm_min_epi32(a, b); }
+			static reg_t max(reg_t a, reg_t b) { return _mm_max_epi32(a, b); }
+		};
+	}
+
+	void fillKernelsSSE41(MathKernelTable<float>& f, MathKernelTable<double>& d, MathKernelTable<std::int32_t>& i)
+	{
+		SimdLoops<SseFloat>::fill(f);
+		SimdLoops<SseDouble>::fill(d);
+		SimdLoops<SseInt32>::fill(i);
+	}
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#else
+
+namespace nf::math::detail
+{
+	void fillKernelsSSE41(MathKernelTable<float>&, MathKernelTable<double>&, MathKernelTable<std::int32_t>&) {}
+}
+
+#endif
@@ -0,0 +1,113 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+#include <type_traits>
+#include <algorithm>
+
+namespace nf::math
+{
+	/**
+	 * @brief Fixed size vector used by the standard math nodes.
+	 * Components are stored contiguously, so a column of Vec<T, N> can be processed as a column of T.
+	*/
+	template<typename T, size_t N>
+	struct Vec
+	{
+		static_assert(N >= 2 && N <= 4, "Vec supports 2 to 4 components");
+
+		T v[N]{};
+
+		constexpr T& operator[](size_t i) noexcept { return v[i]; }
+		constexpr const T& operator[](size_t i) const noexcept { return v[i]; }
+
+		friend constexpr bool operator==(const Vec& a, const Vec& b) noexcept
+		{
+			return std::equal(a.v, a.v + N, b.v);
+		}
+
+		friend std::ostream& operator<<(std::ostream& os, const Vec& vec)
+		{
+			for (size_t i = 0; i < N; i++)
+				os << (i == 0 ? "" : " ") << vec.v[i];
+			return os;
+		}
+
+		friend std::istream& operator>>(std::istream& is, Vec& vec)
+		{
+			for (size_t i = 0; i < N; i++)
+				is >> vec.v[i];
+			return is;
+		}
+	};
+
+	using Vec2f = Vec<float, 2>;
+	using Vec3f = Vec<float, 3>;
+	using Vec4f = Vec<float, 4>;
+	using Vec2d = Vec<double, 2>;
+	using Vec3d = Vec<double, 3>;
+	using Vec4d = Vec<double, 4>;
+	using Vec2i = Vec<std::int32_t, 2>;
+	using Vec3i = Vec<std::int32_t, 3>;
+	using Vec4i = Vec<std::int32_t, 4>;
+
+	/**
+	 * @brief Scalar type and component count of a math type. Scalars have a single component.
+	*/
+	template<typename T>
+	struct vec_traits
+	{
+		using scalar_t = T;
+		static constexpr size_t components = 1;
+	};
+
+	template<typename T, size_t N>
+	struct vec_traits<Vec<T, N>>
+	{
+		using scalar_t = T;
+		static constexpr size_t components = N;
+	};
+
+	template<typename T>
+	using scalar_of_t = typename vec_traits<T>::scalar_t;
+
+	template<typename T>
+	static constexpr bool is_vec_v = vec_traits<T>::components > 1;
+
+	static_assert(sizeof(Vec3f) == 3 * sizeof(float), "Vec must not contain padding");
+}
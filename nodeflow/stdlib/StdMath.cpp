@@ -0,0 +1,93 @@
+#include "stdlib/StdMath.hpp"
+
+namespace nf
+{
+	namespace
+	{
+		const FunctorPortNames binaryNames{ { "A", "B" }, "Result" };
+		const FunctorPortNames fmaNames{ { "A", "B", "C" }, "Result" };
+		const FunctorPortNames clampNames{ { "X", "Min", "Max" }, "Result" };
+		const FunctorPortNames lerpNames{ { "A", "B", "T" }, "Result" };
+		const FunctorPortNames unaryNames{ { "A" }, "Result" };
+
+		// Registered as Purity::PureUncached: a lookup in the result cache would cost more than recomputing
+		template<typename T>
+		Expected<void, RegisterError> registerOps(FlowModule& module, const std::string& typeName)
+		{
+			using namespace nf::math;
+			using Scalar_t = scalar_of_t<T>;
+			const std::string path = "Std/Math/" + typeName + "/";
+
+			Expected<void, RegisterError> results[] = {
+				module.registerType<T>("Std/Types/" + typeName),
+				module.registerFunction<&add<T>, &addColumns<T>>(path + "Add", binaryNames, Purity::PureUncached),
+				module.registerFunction<&mul<T>, &mulColumns<T>>(path + "Mul", binaryNames, Purity::PureUncached),
+				module.registerFunction<&math::fma<T>, &fmaColumns<T>>(path + "Fma", fmaNames, Purity::PureUncached),
+				module.registerFunction<&math::min<T>, &minColumns<T>>(path + "Min", binaryNames, Purity::PureUncached),
+				module.registerFunction<&math::max<T>, &maxColumns<T>>(path + "Max", binaryNames, Purity::PureUncached),
+				module.registerFunction<&clamp<T>, &clampColumns<T>>(path + "Clamp", clampNames, Purity::PureUncached),
+			};
+
+			for (auto& result : results)
+			{
+				if (!result)
+					return result;
+			}
+
+			if constexpr (std::is_floating_point_v<Scalar_t>)
+			{
+				if (auto result = module.registerFunction<&lerp<T>, &lerpColumns<T>>(path + "Lerp", lerpNames, Purity::PureUncached); !result)
+					return result;
+			}
+
+			if constexpr (is_vec_v<T>)
+			{
+				if (auto result = module.registerFunction<&dot<T>, &dotColumns<T>>(path + "Dot", binaryNames, Purity::PureUncached); !result)
+					return result;
+
+				if constexpr (std::is_floating_point_v<Scalar_t>)
+				{
+					if (auto result = module.registerFunction<&length<T>, &lengthColumns<T>>(path + "Length", unaryNames, Purity::PureUncached); !result)
+						return result;
+				}
+			}
+			return {};
+		}
+	}
+
+	Expected<void, RegisterError> registerStdMath(FlowModule& module)
+	{
+		using namespace nf::math;
+
+		Expected<void, RegisterError> results[] = {
+			registerOps<float>(module, "Float"),
+			registerOps<double>(module, "Double"),
+			registerOps<std::int32_t>(module, "Int"),
+			registerOps<Vec2f>(module, "Vec2f"),
+			registerOps<Vec3f>(module, "Vec3f"),
+			registerOps<Vec4f>(module, "Vec4f"),
+			registerOps<Vec2d>(module, "Vec2d"),
+			registerOps<Vec3d>(module, "Vec3d"),
+			registerOps<Vec4d>(module, "Vec4d"),
+			registerOps<Vec2i>(module, "Vec2i"),
+			registerOps<Vec3i>(module, "Vec3i"),
+			registerOps<Vec4i>(module, "Vec4i"),
+		};
+
+		for (auto& result : results)
+		{
+			if (!result)
+				return result;
+		}
+		return {};
+	}
+
+	std::shared_ptr<FlowModule> makeStdMathModule()
+	{
+		auto module = std::make_shared<FlowModule>("Std");
+		auto success = registerStdMath(*module);
+		NF_ASSERT(success, "Standard math nodes collide with each other");
+		NF_UNUSED(success);
+		return module;
+	}
+}
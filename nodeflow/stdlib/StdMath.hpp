@@ -0,0 +1,276 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+#include <span>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include "typedefs.hpp"
+#include "utility/Expected.hpp"
+#include "script/FlowModule.hpp"
+#include "stdlib/MathTypes.hpp"
+#include "stdlib/MathKernels.hpp"
+
+namespace nf
+{
+	/**
+	 * @brief Registers the standard math nodes under "Std/Math/<Type>/<Op>" and their types under "Std/Types/<Type>".
+	 * Types are Float, Double, Int and Vec2f..Vec4i. Ops are Add, Mul, Fma, Min, Max and Clamp for all types,
+	 * Lerp for floating point types, Dot for vectors and Length for floating point vectors.
+	 * In batch mode all nodes process whole columns through the kernels of nf::math::mathKernels().
+	*/
+	Expected<void, RegisterError> registerStdMath(FlowModule& module);
+
+	/**
+	 * @brief Creates a FlowModule named "Std" holding the nodes of registerStdMath()
+	*/
+	std::shared_ptr<FlowModule> makeStdMathModule();
+}
+
+namespace nf::math
+{
+	#pragma region Scalar functions
+	// Element-wise on vectors. Used by the nodes in scalar mode
+
+	namespace detail
+	{
+		// Computed like the column kernels, so integer overflow wraps around in scalar and batch mode alike
+
+		template<typename S>
+		inline S addComponent(S a, S b)
+		{
+			using U = kernel_arithmetic_t<S>;
+			return static_cast<S>(static_cast<U>(a) + static_cast<U>(b));
+		}
+
+		template<typename S>
+		inline S mulComponent(S a, S b)
+		{
+			using U = kernel_arithmetic_t<S>;
+			return static_cast<S>(static_cast<U>(a) * static_cast<U>(b));
+		}
+
+		template<typename S>
+		inline S fmaComponent(S a, S b, S c)
+		{
+			using U = kernel_arithmetic_t<S>;
+			return static_cast<S>(static_cast<U>(a) * static_cast<U>(b) + static_cast<U>(c));
+		}
+	}
+
+	template<typename T>
+	T add(T a, T b)
+	{
+		if constexpr (is_vec_v<T>)
+		{
+			for (size_t i = 0; i < vec_traits<T>::components; i++)
+				a[i] = detail::addComponent(a[i], b[i]);
+			return a;
+		}
+		else
+			return detail::addComponent(a, b);
+	}
+
+	template<typename T>
+	T mul(T a, T b)
+	{
+		if constexpr (is_vec_v<T>)
+		{
+			for (size_t i = 0; i < vec_traits<T>::components; i++)
+				a[i] = detail::mulComponent(a[i], b[i]);
+			return a;
+		}
+		else
+			return detail::mulComponent(a, b);
+	}
+
+	template<typename T>
+	T fma(T a, T b, T c)
+	{
+		if constexpr (is_vec_v<T>)
+		{
+			for (size_t i = 0; i < vec_traits<T>::components; i++)
+				a[i] = detail::fmaComponent(a[i], b[i], c[i]);
+			return a;
+		}
+		else
+			return detail::fmaComponent(a, b, c);
+	}
+
+	template<typename T>
+	T min(T a, T b)
+	{
+		if constexpr (is_vec_v<T>)
+		{
+			for (size_t i = 0; i < vec_traits<T>::components; i++)
+				a[i] = std::min(a[i], b[i]);
+			return a;
+		}
+		else
+			return std::min(a, b);
+	}
+
+	template<typename T>
+	T max(T a, T b)
+	{
+		if constexpr (is_vec_v<T>)
+		{
+			for (size_t i = 0; i < vec_traits<T>::components; i++)
+				a[i] = std::max(a[i], b[i]);
+			return a;
+		}
+		else
+			return std::max(a, b);
+	}
+
+	template<typename T>
+	T clamp(T x, T lo, T hi)
+	{
+		// Not std::clamp, which asserts lo <= hi
+		return min(max(x, lo), hi);
+	}
+
+	template<typename T>
+	T lerp(T a, T b, scalar_of_t<T> t)
+	{
+		if constexpr (is_vec_v<T>)
+		{
+			for (size_t i = 0; i < vec_traits<T>::components; i++)
+				a[i] = a[i] + (b[i] - a[i]) * t;
+			return a;
+		}
+		else
+			return a + (b - a) * t;
+	}
+
+	template<typename T>
+	scalar_of_t<T> dot(T a, T b)
+	{
+		scalar_of_t<T> sum{};
+		for (size_t i = 0; i < vec_traits<T>::components; i++)
+			sum += a[i] * b[i];
+		return sum;
+	}
+
+	template<typename T>
+	scalar_of_t<T> length(T a)
+	{
+		return std::sqrt(dot(a, a));
+	}
+	#pragma endregion
+
+	#pragma region Column kernels
+	// Used by the nodes in batch mode. Columns of vectors are processed as columns of their components
+
+	namespace detail
+	{
+		template<typename T>
+		inline scalar_of_t<T>* components(std::span<T> column) { return reinterpret_cast<scalar_of_t<T>*>(column.data()); }
+
+		template<typename T>
+		inline const scalar_of_t<T>* components(std::span<const T> column) { return reinterpret_cast<const scalar_of_t<T>*>(column.data()); }
+
+		template<typename T>
+		inline size_t componentCount(std::span<T> column) { return column.size() * vec_traits<T>::components; }
+	}
+
+	template<typename T>
+	void addColumns(std::span<T> out, std::span<const T> a, std::span<const T> b)
+	{
+		mathKernels<scalar_of_t<T>>().add(detail::components(out), detail::components(a), detail::components(b), detail::componentCount(out));
+	}
+
+	template<typename T>
+	void mulColumns(std::span<T> out, std::span<const T> a, std::span<const T> b)
+	{
+		mathKernels<scalar_of_t<T>>().mul(detail::components(out), detail::components(a), detail::components(b), detail::componentCount(out));
+	}
+
+	template<typename T>
+	void fmaColumns(std::span<T> out, std::span<const T> a, std::span<const T> b, std::span<const T> c)
+	{
+		mathKernels<scalar_of_t<T>>().fma(detail::components(out), detail::components(a), detail::components(b),
+			detail::components(c), detail::componentCount(out));
+	}
+
+	template<typename T>
+	void minColumns(std::span<T> out, std::span<const T> a, std::span<const T> b)
+	{
+		mathKernels<scalar_of_t<T>>().min(detail::components(out), detail::components(a), detail::components(b), detail::componentCount(out));
+	}
+
+	template<typename T>
+	void maxColumns(std::span<T> out, std::span<const T> a, std::span<const T> b)
+	{
+		mathKernels<scalar_of_t<T>>().max(detail::components(out), detail::components(a), detail::components(b), detail::componentCount(out));
+	}
+
+	template<typename T>
+	void clampColumns(std::span<T> out, std::span<const T> x, std::span<const T> lo, std::span<const T> hi)
+	{
+		mathKernels<scalar_of_t<T>>().clamp(detail::components(out), detail::components(x), detail::components(lo),
+			detail::components(hi), detail::componentCount(out));
+	}
+
+	template<typename T>
+	void lerpColumns(std::span<T> out, std::span<const T> a, std::span<const T> b, std::span<const scalar_of_t<T>> t)
+	{
+		if constexpr (is_vec_v<T>)
+		{
+			// 't' is shared by all components of a record
+			for (size_t i = 0; i < out.size(); i++)
+				out[i] = lerp(a[i], b[i], t[i]);
+		}
+		else
+			mathKernels<T>().lerp(out.data(), a.data(), b.data(), t.data(), out.size());
+	}
+
+	template<typename T>
+	void dotColumns(std::span<scalar_of_t<T>> out, std::span<const T> a, std::span<const T> b)
+	{
+		for (size_t i = 0; i < out.size(); i++)
+			out[i] = dot(a[i], b[i]);
+	}
+
+	template<typename T>
+	void lengthColumns(std::span<scalar_of_t<T>> out, std::span<const T> a)
+	{
+		for (size_t i = 0; i < out.size(); i++)
+			out[i] = length(a[i]);
+	}
+	#pragma endregion
+}
@@ -0,0 +1,43 @@
+#include "utility/NameTable.hpp"
+
+namespace nf
+{
+
+	InternedName::InternedName(std::string_view name)
+		: m_entry(name.empty() ? &s_empty : NameTable::instance().intern(name).m_entry)
+	{
+	}
+
+	NameTable::NameTable()
+	{
+		m_byId.push_back(&InternedName::s_empty);
+		m_index.emplace(InternedName::s_empty.text, &InternedName::s_empty);
+	}
+
+	InternedName NameTable::intern(std::string_view name)
+	{
+		std::lock_guard lock(m_mutex);
+		if (auto found = m_index.find(name); found != m_index.end())
+			return InternedName(found->second);
+
+		const auto& entry = m_entries.emplace_back(std::string(name), static_cast<NameId>(m_byId.size()));
+		m_byId.push_back(&entry);
+		m_index.emplace(entry.text, &entry);
+		return InternedName(&entry);
+	}
+
+	InternedName NameTable::find(NameId id) const
+	{
+		std::lock_guard lock(m_mutex);
+		if (!(id < m_byId.size()))
+			return InternedName();
+		return InternedName(m_byId[id]);
+	}
+
+	size_t NameTable::size() const
+	{
+		std::lock_guard lock(m_mutex);
+		return m_byId.size();
+	}
+
+}
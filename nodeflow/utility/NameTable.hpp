@@ -0,0 +1,134 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "utility/Singleton.hpp"
+
+namespace nf
+{
+	using NameId = std::uint32_t;
+
+	/**
+	 * @brief Name stored once in the NameTable. As cheap to copy as a pointer, compared by identity instead of text.
+	 * The text stays valid until the program ends.
+	*/
+	class InternedName
+	{
+		friend class NameTable;
+
+		struct Entry
+		{
+			std::string text;
+			NameId id = 0;
+		};
+
+	public:
+		/**
+		 * @brief Returns the empty name, which has id 0
+		*/
+		InternedName() noexcept = default;
+
+		/**
+		 * @brief Interns 'name' (see NameTable::intern())
+		*/
+		explicit InternedName(std::string_view name);
+
+		inline std::string_view view() const noexcept { return m_entry->text; }
+
+		inline NameId id() const noexcept { return m_entry->id; }
+
+		inline bool empty() const noexcept { return m_entry->text.empty(); }
+
+		inline operator std::string_view() const noexcept { return view(); }
+
+		inline bool operator==(const InternedName& rhs) const noexcept { return m_entry == rhs.m_entry; }
+
+		friend std::ostream& operator<< (std::ostream& stream, const InternedName& name)
+		{
+			return stream << name.view();
+		}
+
+	private:
+		explicit InternedName(const Entry* entry) noexcept
+			: m_entry(entry)
+		{}
+
+	private:
+		static const Entry s_empty;
+		const Entry* m_entry = &s_empty;
+	};
+
+	inline const InternedName::Entry InternedName::s_empty{};
+
+	/**
+	 * @brief Process-wide table of node and port names. Every distinct name is stored once and gets a NameId,
+	 * so names can be handed out as string_view or id without allocating. Names are never removed.
+	*/
+	class NameTable : public Singleton<NameTable>
+	{
+	public:
+		NameTable();
+
+		/**
+		 * @brief Returns the interned version of 'name' and adds it to the table if it's not there yet
+		*/
+		InternedName intern(std::string_view name);
+
+		/**
+		 * @brief Returns the name with the id 'id'
+		 * @return the empty name if 'id' is unknown
+		*/
+		InternedName find(NameId id) const;
+
+		/**
+		 * @brief Returns the number of names in the table, including the empty name
+		*/
+		size_t size() const;
+
+	private:
+		mutable std::mutex m_mutex;
+		std::deque<InternedName::Entry> m_entries; // Never relocates its elements, so InternedNames stay valid
+		std::vector<const InternedName::Entry*> m_byId;
+		std::unordered_map<std::string_view, const InternedName::Entry*> m_index; // Keys view into m_entries
+	};
+}
@@ -0,0 +1,169 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+#include <vector>
+#include <optional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <bit>
+#include <cstddef>
+
+namespace nf
+{
+	/**
+	 * @brief Bounded lock-free queue for exactly one producer and one consumer thread.
+	 * Capacity is rounded up to a power of two. Each side caches the position of the other one,
+	 * so the shared atomics are only read again once the queue looks full or empty.
+	 * Either side may block until the other one made progress. The mutex is only taken while a thread waits.
+	*/
+	template<typename T>
+	class SpscQueue
+	{
+	public:
+		explicit SpscQueue(size_t capacity)
+			: m_slots(std::bit_ceil(capacity < 2 ? size_t(2) : capacity)), m_mask(m_slots.size() - 1)
+		{}
+
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator=(const SpscQueue&) = delete;
+
+		/**
+		 * @brief Producer side. 'value' is only moved from if it was enqueued.
+		 * @return 'false' if the queue is full
+		*/
+		bool tryPush(T&& value)
+		{
+			const size_t tail = m_tail.load(std::memory_order_relaxed);
+			if (tail - m_headCache == m_slots.size())
+			{
+				m_headCache = m_head.load(std::memory_order_acquire);
+				if (tail - m_headCache == m_slots.size())
+					return false;
+			}
+
+			m_slots[tail & m_mask].emplace(std::move(value));
+			m_tail.store(tail + 1, std::memory_order_release);
+			notifyWaiters();
+			return true;
+		}
+
+		/**
+		 * @brief Consumer side
+		 * @return std::nullopt if the queue is empty
+		*/
+		std::optional<T> tryPop()
+		{
+			const size_t head = m_head.load(std::memory_order_relaxed);
+			if (head == m_tailCache)
+			{
+				m_tailCache = m_tail.load(std::memory_order_acquire);
+				if (head == m_tailCache)
+					return std::nullopt;
+			}
+
+			auto& slot = m_slots[head & m_mask];
+			std::optional<T> value(std::move(slot));
+			slot.reset();
+			m_head.store(head + 1, std::memory_order_release);
+			notifyWaiters();
+			return value;
+		}
+
+		/**
+		 * @brief Consumer side. Blocks until the queue holds an element or 'stop' is set.
+		 * @return 'false' if it returned because of 'stop'
+		*/
+		bool waitUntilReadable(const std::atomic<bool>& stop)
+		{
+			return waitFor(stop, [this] { return m_tail.load() != m_head.load(std::memory_order_relaxed); });
+		}
+
+		/**
+		 * @brief Producer side. Blocks until the queue has a free slot or 'stop' is set.
+		 * @return 'false' if it returned because of 'stop'
+		*/
+		bool waitUntilWritable(const std::atomic<bool>& stop)
+		{
+			return waitFor(stop, [this] { return m_tail.load(std::memory_order_relaxed) - m_head.load() != m_slots.size(); });
+		}
+
+		/**
+		 * @brief Wakes all threads blocked in waitUntilReadable() or waitUntilWritable(), so they see their 'stop' flag
+		*/
+		void wakeAll()
+		{
+			std::lock_guard lock(m_waitMutex);
+			m_waitCondition.notify_all();
+		}
+
+		inline size_t capacity() const noexcept { return m_slots.size(); }
+
+	private:
+		template<typename Predicate>
+		bool waitFor(const std::atomic<bool>& stop, Predicate ready)
+		{
+			std::unique_lock lock(m_waitMutex);
+			m_waiters.fetch_add(1);
+			m_waitCondition.wait(lock, [&] { return ready() || stop.load(); });
+			m_waiters.fetch_sub(1, std::memory_order_relaxed);
+			return !stop.load();
+		}
+
+		void notifyWaiters()
+		{
+			// Pairs with the increment in waitFor(): either the waiter sees the new position or we see the waiter
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (m_waiters.load(std::memory_order_relaxed) == 0)
+				return;
+
+			std::lock_guard lock(m_waitMutex);
+			m_waitCondition.notify_all();
+		}
+
+	private:
+		std::vector<std::optional<T>> m_slots;
+		const size_t m_mask;
+
+		// Producer and consumer state on separate cache lines, so they don't invalidate each other
+		alignas(64) std::atomic<size_t> m_tail{ 0 };
+		size_t m_headCache = 0;		// Last head seen by the producer
+		alignas(64) std::atomic<size_t> m_head{ 0 };
+		size_t m_tailCache = 0;		// Last tail seen by the consumer
+
+		alignas(64) std::atomic<int> m_waiters{ 0 };
+		std::mutex m_waitMutex;
+		std::condition_variable m_waitCondition;
+	};
+}
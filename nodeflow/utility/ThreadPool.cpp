@@ -0,0 +1,114 @@
+#include "utility/ThreadPool.hpp"
+#include "typedefs.hpp"
+
+#include <algorithm>
+
+namespace nf
+{
+	namespace
+	{
+		thread_local const ThreadPool* t_currentPool = nullptr;
+		thread_local size_t t_workerIndex = 0;
+	}
+
+	ThreadPool::ThreadPool(size_t workerCount /*= 0*/)
+	{
+		if (workerCount == 0)
+			workerCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+		m_workers.reserve(workerCount);
+		for (size_t i = 0; i < workerCount; i++)
+			m_workers.push_back(std::make_unique<WorkerQueue>());
+
+		m_threads.reserve(workerCount);
+		for (size_t i = 0; i < workerCount; i++)
+			m_threads.emplace_back([this, i]() { workerLoop(i); });
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard lock(m_sleepMutex);
+			m_stop = true;
+		}
+		m_wakeup.notify_all();
+
+		for (auto& thread : m_threads)
+			thread.join();
+	}
+
+	void ThreadPool::submit(Task task)
+	{
+		NF_ASSERT(task.invoke != nullptr, "Task has nothing to invoke");
+
+		// Keep tasks spawned by a worker local to it. Others are distributed round robin.
+		size_t queueIndex = (t_currentPool == this) ? t_workerIndex
+			: m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+
+		{
+			auto& queue = *m_workers[queueIndex];
+			std::lock_guard lock(queue.mutex);
+			queue.tasks.push_back(task);
+			// Counted under the queue lock, so no worker can pop the task and decrement first
+			m_queuedTasks.fetch_add(1, std::memory_order_release);
+		}
+
+		// Synchronize with workers that are about to sleep, otherwise the wakeup might get lost
+		{
+			std::lock_guard lock(m_sleepMutex);
+		}
+		m_wakeup.notify_one();
+	}
+
+	void ThreadPool::workerLoop(size_t index)
+	{
+		t_currentPool = this;
+		t_workerIndex = index;
+
+		while (true)
+		{
+			Task task;
+			if (popTask(index, task))
+			{
+				task.invoke(task.context, task.index);
+				continue;
+			}
+
+			std::unique_lock lock(m_sleepMutex);
+			m_wakeup.wait(lock, [this]() { return m_stop || m_queuedTasks.load(std::memory_order_acquire) != 0; });
+			if (m_stop && m_queuedTasks.load(std::memory_order_acquire) == 0)
+				return;
+		}
+	}
+
+	bool ThreadPool::popTask(size_t index, Task& task)
+	{
+		// Own queue first (LIFO for cache locality)
+		{
+			auto& queue = *m_workers[index];
+			std::lock_guard lock(queue.mutex);
+			if (!queue.tasks.empty())
+			{
+				task = queue.tasks.back();
+				queue.tasks.pop_back();
+				m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+
+		// Steal oldest task of another worker
+		for (size_t offset = 1; offset < m_workers.size(); offset++)
+		{
+			auto& victim = *m_workers[(index + offset) % m_workers.size()];
+			std::lock_guard lock(victim.mutex);
+			if (!victim.tasks.empty())
+			{
+				task = victim.tasks.front();
+				victim.tasks.pop_front();
+				m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		return false;
+	}
+}
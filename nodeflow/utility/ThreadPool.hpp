@@ -0,0 +1,98 @@
+/*
+- nodeflow -
+BSD 3-Clause License
+
+Copyright (c) 2022, Ruwen Kohm
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+namespace nf
+{
+	/**
+	 * @brief Fixed size thread pool with one task queue per worker.
+	 * Workers pop from the back of their own queue and steal from the front of the others when idle.
+	 * Tasks submitted from a worker thread are pushed to the queue of that worker.
+	*/
+	class ThreadPool
+	{
+	public:
+		/**
+		 * @brief Lightweight task. Avoids the allocation of a std::function per submitted task.
+		*/
+		struct Task
+		{
+			void (*invoke)(void* context, std::uint32_t index) = nullptr;
+			void* context = nullptr;
+			std::uint32_t index = 0;
+		};
+
+	public:
+		/**
+		 * @param workerCount number of worker threads. 0 uses std::thread::hardware_concurrency()
+		*/
+		explicit ThreadPool(size_t workerCount = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		void submit(Task task);
+
+		inline size_t workerCount() const noexcept { return m_workers.size(); }
+
+	private:
+		struct WorkerQueue
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		void workerLoop(size_t index);
+
+		bool popTask(size_t index, Task& task);
+
+	private:
+		std::vector<std::unique_ptr<WorkerQueue>> m_workers;
+		std::vector<std::thread> m_threads;
+		std::mutex m_sleepMutex;
+		std::condition_variable m_wakeup;
+		std::atomic<size_t> m_queuedTasks{ 0 };
+		std::atomic<size_t> m_nextQueue{ 0 };
+		bool m_stop = false;
+	};
+}